@@ -6,15 +6,19 @@
 // IWYU pragma: private, include "tit/core/mat.hpp"
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <span>
 #include <utility>
 
 #include "tit/core/_mat/mat.hpp"
 #include "tit/core/_mat/part.hpp"
 #include "tit/core/_mat/traits.hpp"
+#include "tit/core/assert.hpp"
 #include "tit/core/math.hpp"
+#include "tit/core/simd.hpp"
 
 namespace tit {
 
@@ -261,4 +265,156 @@ constexpr auto ldl(const Mat<Num, Dim>& A)
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/// Closed-form inverse of a small matrix.
+template<class Mat>
+  requires is_mat_v<Mat>
+class FactInv final {
+public:
+
+  /// Initialize a factorization.
+  constexpr FactInv(Mat A_inv, mat_num_t<Mat> det) noexcept
+      : A_inv_{std::move(A_inv)}, det_{std::move(det)} {}
+
+  /// Determinant of the matrix.
+  constexpr auto det() const -> mat_num_t<Mat> {
+    return det_;
+  }
+
+  /// Solve the matrix equation.
+  template<mat_multiplier<Mat> Mult>
+  constexpr auto solve(const Mult& x) const -> Mult {
+    return A_inv_ * x;
+  }
+
+  /// Compute the inverse matrix.
+  constexpr auto inverse() const -> const Mat& {
+    return A_inv_;
+  }
+
+private:
+
+  Mat A_inv_{};
+  mat_num_t<Mat> det_{};
+
+}; // class FactInv
+
+namespace impl {
+
+// Compute the adjugate and the determinant of a small row-major matrix,
+// given by its entries. Entries may be the SIMD registers, so that the
+// matrices in the structure-of-arrays layout are processed lane-wise.
+template<std::size_t Dim, class Num>
+constexpr auto adjugate(const std::array<Num, Dim * Dim>& a)
+    -> std::pair<std::array<Num, Dim * Dim>, Num> {
+  if constexpr (Dim == 1) {
+    return {{Num{1}}, a[0]};
+  } else if constexpr (Dim == 2) {
+    return {{a[3], -a[1], -a[2], a[0]}, a[0] * a[3] - a[1] * a[2]};
+  } else if constexpr (Dim == 3) {
+    std::array<Num, 9> adj{
+        a[4] * a[8] - a[5] * a[7],
+        a[2] * a[7] - a[1] * a[8],
+        a[1] * a[5] - a[2] * a[4],
+        a[5] * a[6] - a[3] * a[8],
+        a[0] * a[8] - a[2] * a[6],
+        a[2] * a[3] - a[0] * a[5],
+        a[3] * a[7] - a[4] * a[6],
+        a[1] * a[6] - a[0] * a[7],
+        a[0] * a[4] - a[1] * a[3],
+    };
+    auto det = a[0] * adj[0] + a[1] * adj[3] + a[2] * adj[6];
+    return {std::move(adj), std::move(det)};
+  } else {
+    static_assert(false);
+  }
+}
+
+} // namespace impl
+
+/// Compute the inverse of a small matrix with the cofactor expansion.
+///
+/// Much cheaper than the inverse through a factorization for the matrices of
+/// size up to 3x3. Matrix is considered near-singular if its determinant is
+/// tiny.
+template<class Num, std::size_t Dim>
+  requires (1 <= Dim && Dim <= 3)
+constexpr auto inv(const Mat<Num, Dim>& A)
+    -> FactResult<FactInv<Mat<Num, Dim>>> {
+  std::array<Num, Dim * Dim> a;
+  for (std::size_t i = 0; i < Dim; ++i) {
+    for (std::size_t j = 0; j < Dim; ++j) a[i * Dim + j] = A[i, j];
+  }
+  const auto [adj, det] = impl::adjugate<Dim>(a);
+  if (is_tiny(det)) return std::unexpected{FactError::near_singular};
+  const auto det_inv = inverse(det);
+  Mat<Num, Dim> A_inv;
+  for (std::size_t i = 0; i < Dim; ++i) {
+    for (std::size_t j = 0; j < Dim; ++j) {
+      A_inv[i, j] = adj[i * Dim + j] * det_inv;
+    }
+  }
+  return FactInv{std::move(A_inv), det};
+}
+
+/// Compute the inverses of the small matrices in a batch.
+///
+/// Matrices are processed in the groups of the SIMD register size: group is
+/// transposed into the structure-of-arrays layout, and the cofactor expansion
+/// is computed for all of its matrices at once. Inverses of the near-singular
+/// matrices are replaced with the identity. Input and output may be the same.
+///
+/// @returns Number of the near-singular matrices.
+template<class Num, std::size_t Dim>
+  requires (1 <= Dim && Dim <= 3)
+auto inv_batch(std::span<const Mat<Num, Dim>> A,
+               std::span<Mat<Num, Dim>> A_inv) -> std::size_t {
+  TIT_ASSERT(A.size() == A_inv.size(), "Batch sizes do not match!");
+  std::size_t num_singular = 0;
+  std::size_t first = 0;
+  TIT_IF_SIMD_AVALIABLE(Num) {
+    constexpr auto Size = simd::max_reg_size_v<Num>;
+    using Reg = simd::Reg<Num, Size>;
+    constexpr auto num_entries = Dim * Dim;
+    for (; first + Size <= A.size(); first += Size) {
+      std::array<std::array<Num, Size>, num_entries> lanes;
+      for (std::size_t k = 0; k < Size; ++k) {
+        for (std::size_t i = 0; i < Dim; ++i) {
+          for (std::size_t j = 0; j < Dim; ++j) {
+            lanes[i * Dim + j][k] = A[first + k][i, j];
+          }
+        }
+      }
+      std::array<Reg, num_entries> a;
+      for (std::size_t e = 0; e < num_entries; ++e) a[e] = Reg{lanes[e]};
+      const auto [adj, det] = impl::adjugate<Dim>(a);
+      const auto is_regular = abs(det) > Reg{tiny_v<Num>};
+      num_singular += static_cast<std::size_t>(
+          simd::sum(simd::filter(!is_regular, Reg{1})));
+      const auto det_inv = Reg{1} / det;
+      for (std::size_t e = 0; e < num_entries; ++e) {
+        const Reg eye_e{e % (Dim + 1) == 0 ? Num{1} : Num{0}};
+        simd::select(is_regular, adj[e] * det_inv, eye_e).store(lanes[e]);
+      }
+      for (std::size_t k = 0; k < Size; ++k) {
+        for (std::size_t i = 0; i < Dim; ++i) {
+          for (std::size_t j = 0; j < Dim; ++j) {
+            A_inv[first + k][i, j] = lanes[i * Dim + j][k];
+          }
+        }
+      }
+    }
+  }
+  for (std::size_t k = first; k < A.size(); ++k) {
+    if (const auto fact = inv(A[k])) {
+      A_inv[k] = fact->inverse();
+    } else {
+      A_inv[k] = eye(A[k]);
+      num_singular += 1;
+    }
+  }
+  return num_singular;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace tit
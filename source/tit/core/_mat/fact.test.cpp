@@ -3,6 +3,10 @@
  * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <ranges>
+#include <span>
+#include <vector>
+
 #include "tit/core/mat.hpp"
 #include "tit/core/math.hpp" // IWYU pragma: keep
 #include "tit/core/vec.hpp"
@@ -388,5 +392,117 @@ TEST_CASE("Mat::ldl") {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+TEST_CASE("Mat::inv") {
+  SUBCASE("1x1") {
+    const Mat A{{2.0}};
+    const auto fact = inv(A);
+    REQUIRE(fact);
+    CHECK_APPROX_EQ(fact->det(), 2.0);
+    CHECK_APPROX_EQ(fact->solve(Vec{6.0}), Vec{3.0});
+    CHECK_APPROX_EQ(fact->inverse(), Mat{{0.5}});
+  }
+  SUBCASE("2x2") {
+    const Mat A{
+        {4.0, 7.0},
+        {2.0, 6.0},
+    };
+    const auto fact = inv(A);
+    REQUIRE(fact);
+    SUBCASE("det") {
+      CHECK_APPROX_EQ(fact->det(), 10.0);
+    }
+    SUBCASE("solve") {
+      const Vec b{18.0, 14.0};
+      const Vec x{1.0, 2.0};
+      REQUIRE(A * x == b);
+      CHECK_APPROX_EQ(fact->solve(b), x);
+    }
+    SUBCASE("inverse") {
+      // clang-format off
+      const Mat A_inv{
+          { 0.6, -0.7},
+          {-0.2,  0.4},
+      };
+      // clang-format on
+      REQUIRE_APPROX_EQ(A * A_inv, eye(A));
+      CHECK_APPROX_EQ(fact->inverse(), A_inv);
+    }
+  }
+  SUBCASE("3x3") {
+    // clang-format off
+    const Mat A{
+        {  4.0,  12.0, -16.0},
+        { 12.0,  37.0, -43.0},
+        {-16.0, -43.0,  98.0},
+    };
+    // clang-format on
+    const auto fact = inv(A);
+    REQUIRE(fact);
+    SUBCASE("det") {
+      CHECK_APPROX_EQ(fact->det(), 36.0);
+    }
+    SUBCASE("solve") {
+      const Vec b{9.0, 9.0, 9.0};
+      const Vec x{341.25, -93.0, 15.0};
+      REQUIRE(A * x == b);
+      CHECK_APPROX_EQ(fact->solve(b), x);
+    }
+    SUBCASE("inverse") {
+      // clang-format off
+      const auto A_inv = Mat{
+          {444.25, -122.0, 19.0},
+          {-122.0,   34.0, -5.0},
+          {  19.0,   -5.0,  1.0},
+      } / 9.0;
+      // clang-format on
+      REQUIRE_APPROX_EQ(A * A_inv, eye(A));
+      CHECK_APPROX_EQ(fact->inverse(), A_inv);
+    }
+  }
+  SUBCASE("3x3 singular") {
+    const Mat A{
+        {1.0, 2.0, 3.0},
+        {4.0, 5.0, 6.0},
+        {7.0, 8.0, 9.0},
+    };
+    const auto fact = inv(A);
+    REQUIRE(!fact);
+    CHECK(fact.error() == FactError::near_singular);
+  }
+}
+
+TEST_CASE("Mat::inv_batch") {
+  // Batch is larger than any SIMD register, and is not a multiple of its
+  // size, so that both the vectorized and the remainder paths are taken.
+  std::vector<Mat<double, 3>> A(19);
+  for (const auto& [k, A_k] : std::views::enumerate(A)) {
+    const auto t = static_cast<double>(k);
+    A_k = Mat{
+        {4.0 + t, 1.0, 0.0},
+        {1.0, 3.0, t},
+        {0.0, t, 2.0 + t},
+    };
+  }
+  A[3] = Mat<double, 3>{};
+  A[18] = Mat<double, 3>{};
+  std::vector<Mat<double, 3>> A_inv(A.size());
+  CHECK(inv_batch(std::span<const Mat<double, 3>>{A}, std::span{A_inv}) == 2);
+  for (const auto& [A_k, A_inv_k] : std::views::zip(A, A_inv)) {
+    if (const auto fact = inv(A_k)) {
+      CHECK_APPROX_EQ(A_inv_k, fact->inverse());
+    } else {
+      CHECK(A_inv_k == eye(A_k));
+    }
+  }
+
+  // Inverse in-place.
+  inv_batch(std::span<const Mat<double, 3>>{A_inv}, std::span{A_inv});
+  for (const auto& [A_k, A_inv_inv_k] : std::views::zip(A, A_inv)) {
+    if (inv(A_k)) CHECK_APPROX_EQ(A_inv_inv_k, A_k);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace
 } // namespace tit
@@ -0,0 +1,150 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+#include "tit/core/arena.hpp"
+#include "tit/core/assert.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/memory.hpp"
+#include "tit/core/type.hpp"
+
+namespace tit {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+Arena::~Arena() {
+  release_chunks_();
+}
+
+auto Arena::capacity() const noexcept -> std::size_t {
+  const std::scoped_lock lock{mutex_};
+  return std::transform_reduce(chunks_.begin(),
+                               chunks_.end(),
+                               std::size_t{0},
+                               std::plus{},
+                               [](const auto& chunk) {
+                                 return chunk->num_blocks * sizeof(Block_);
+                               });
+}
+
+auto Arena::num_chunks() const noexcept -> std::size_t {
+  const std::scoped_lock lock{mutex_};
+  return chunks_.size();
+}
+
+auto Arena::allocate(std::size_t size, std::size_t align) -> void* {
+  TIT_ASSERT(align > 0 && align <= max_align, "Alignment is not supported!");
+  while (true) {
+    // Bump the offset in the current chunk.
+    auto* const chunk = current_chunk_.load(std::memory_order_acquire);
+    auto* const ptr =
+        chunk == nullptr ? nullptr : try_allocate_(*chunk, size, align);
+    if (ptr != nullptr) return ptr;
+
+    // Current chunk has no room left, add a new one and try again.
+    grow_(chunk, size);
+  }
+}
+
+void Arena::reset() {
+  const std::scoped_lock lock{mutex_};
+  if (chunks_.size() <= 1) {
+    if (!chunks_.empty()) chunks_.front()->offset.store(0);
+    return;
+  }
+
+  // Merge the chunks, so that the next cycle fits into a single one.
+  const auto num_blocks = std::transform_reduce(
+      chunks_.begin(),
+      chunks_.end(),
+      std::size_t{0},
+      std::plus{},
+      [](const auto& chunk) { return chunk->num_blocks; });
+  release_chunks_();
+  add_chunk_(num_blocks);
+}
+
+auto Arena::try_allocate_(Chunk_& chunk,
+                          std::size_t size,
+                          std::size_t align) noexcept -> void* {
+  const auto chunk_size = chunk.num_blocks * sizeof(Block_);
+  auto offset = chunk.offset.load(std::memory_order_relaxed);
+  while (true) {
+    const auto aligned_offset = divide_up(offset, align) * align;
+    if (aligned_offset + size > chunk_size) return nullptr;
+    if (chunk.offset.compare_exchange_weak(offset,
+                                           aligned_offset + size,
+                                           std::memory_order_relaxed)) {
+      return safe_bit_ptr_cast<std::byte*>(chunk.blocks) + aligned_offset;
+    }
+  }
+}
+
+void Arena::grow_(const Chunk_* full_chunk, std::size_t size) {
+  const std::scoped_lock lock{mutex_};
+
+  // Some other thread may have already added a new chunk.
+  if (current_chunk_.load(std::memory_order_relaxed) != full_chunk) return;
+
+  const auto num_blocks = divide_up(size, sizeof(Block_));
+  const auto last_blocks =
+      full_chunk == nullptr ? std::size_t{0} : full_chunk->num_blocks;
+  add_chunk_(std::max({num_blocks, 2 * last_blocks, min_chunk_blocks_}));
+}
+
+void Arena::add_chunk_(std::size_t num_blocks) {
+  chunks_.reserve(chunks_.size() + 1);
+  auto chunk = std::make_unique<Chunk_>(
+      static_cast<Block_*>(
+          allocate_huge(num_blocks * sizeof(Block_), alignof(Block_))),
+      num_blocks,
+      std::size_t{0});
+  current_chunk_.store(chunk.get(), std::memory_order_release);
+  chunks_.push_back(std::move(chunk));
+}
+
+void Arena::release_chunks_() noexcept {
+  current_chunk_.store(nullptr, std::memory_order_relaxed);
+  for (const auto& chunk : chunks_) {
+    deallocate_huge(chunk->blocks,
+                    chunk->num_blocks * sizeof(Block_),
+                    alignof(Block_));
+  }
+  chunks_.clear();
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace {
+// Current arena is set by the main thread and read by the worker threads.
+std::atomic<Arena*> current_arena_ = nullptr;
+} // namespace
+
+auto current_arena() noexcept -> Arena* {
+  return current_arena_.load(std::memory_order_acquire);
+}
+
+ArenaScope::ArenaScope(Arena& arena) noexcept
+    : arena_{&arena},
+      prev_arena_{current_arena_.exchange(&arena, std::memory_order_acq_rel)} {
+  TIT_ASSERT(prev_arena_ != arena_, "Arena scopes may not be nested!");
+}
+
+ArenaScope::~ArenaScope() {
+  current_arena_.store(prev_arena_, std::memory_order_release);
+  arena_->reset();
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit
@@ -0,0 +1,202 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "tit/core/memory.hpp"
+
+namespace tit {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Monotonic memory arena.
+///
+/// Memory is allocated by atomically bumping an offset in the current chunk,
+/// and is released all at once when the arena is reset. A lock is taken only
+/// when the current chunk has no room left and a new one is added. Memory
+/// chunks are retained between the resets, so that the repeated allocation
+/// patterns (like the time steps) do not hit the heap once the arena has
+/// grown large enough. Chunks are backed by the huge pages, if enabled.
+class Arena final {
+public:
+
+  /// Maximum supported alignment.
+  static constexpr std::size_t max_align = 64;
+
+  /// Construct an empty arena.
+  Arena() = default;
+
+  /// Arena is not move-constructible.
+  Arena(Arena&&) = delete;
+
+  /// Arena is not move-assignable.
+  auto operator=(Arena&&) -> Arena& = delete;
+
+  /// Arena is not copy-constructible.
+  Arena(const Arena&) = delete;
+
+  /// Arena is not copy-assignable.
+  auto operator=(const Arena&) -> Arena& = delete;
+
+  /// Destroy the arena and release the memory.
+  ~Arena();
+
+  /// Total size of the memory chunks, in bytes.
+  auto capacity() const noexcept -> std::size_t;
+
+  /// Number of the memory chunks.
+  auto num_chunks() const noexcept -> std::size_t;
+
+  /// Allocate memory. This function is thread-safe.
+  auto allocate(std::size_t size, std::size_t align) -> void*;
+
+  /// Release all the allocated memory at once. If the arena has grown since
+  /// the last reset, the chunks are merged into a single chunk that fits all
+  /// of them. This function must not be called concurrently with any other.
+  void reset();
+
+private:
+
+  struct alignas(max_align) Block_ final {
+    std::array<std::byte, max_align> bytes;
+  };
+
+  struct Chunk_ final {
+    Block_* blocks;
+    std::size_t num_blocks;
+    std::atomic<std::size_t> offset;
+  };
+
+  static constexpr std::size_t min_chunk_blocks_ = huge_page_size / max_align;
+
+  static auto try_allocate_(Chunk_& chunk,
+                            std::size_t size,
+                            std::size_t align) noexcept -> void*;
+  void grow_(const Chunk_* full_chunk, std::size_t size);
+  void add_chunk_(std::size_t num_blocks);
+  void release_chunks_() noexcept;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Chunk_>> chunks_;
+  std::atomic<Chunk_*> current_chunk_ = nullptr;
+
+}; // class Arena
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Current arena, if any.
+auto current_arena() noexcept -> Arena*;
+
+/// Arena scope.
+///
+/// Makes the arena current while the scope is alive, and resets it when the
+/// scope is destroyed.
+class ArenaScope final {
+public:
+
+  /// Make the arena current.
+  explicit ArenaScope(Arena& arena) noexcept;
+
+  /// Restore the previous arena, and reset this one.
+  ~ArenaScope();
+
+  /// This class is not move-constructible.
+  ArenaScope(ArenaScope&&) = delete;
+
+  /// This class is not move-assignable.
+  auto operator=(ArenaScope&&) -> ArenaScope& = delete;
+
+  /// This class is not copy-constructible.
+  ArenaScope(const ArenaScope&) = delete;
+
+  /// This class is not copy-assignable.
+  auto operator=(const ArenaScope&) -> ArenaScope& = delete;
+
+private:
+
+  Arena* arena_;
+  Arena* prev_arena_;
+
+}; // class ArenaScope
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Allocator that allocates from the arena that was current when the
+/// allocator was constructed, or from the heap if there was none.
+///
+/// Deallocation from the arena is a no-op. Containers that use this allocator
+/// must not outlive the arena scope they were created in.
+template<class Val>
+class ArenaAllocator {
+public:
+
+  /// Value type.
+  using value_type = Val;
+
+  /// Memory moves along with the allocator.
+  using propagate_on_container_move_assignment = std::true_type;
+
+  /// Memory is swapped along with the allocator.
+  using propagate_on_container_swap = std::true_type;
+
+  /// Construct an allocator for the current arena.
+  ArenaAllocator() noexcept : arena_{current_arena()} {}
+
+  /// Construct an allocator for the specified arena.
+  constexpr explicit ArenaAllocator(Arena* arena) noexcept : arena_{arena} {}
+
+  /// Construct an allocator from the allocator of a different type.
+  template<class Other>
+  constexpr explicit(false)
+      ArenaAllocator(const ArenaAllocator<Other>& other) noexcept
+      : arena_{other.arena()} {}
+
+  /// Arena of the allocator, if any.
+  constexpr auto arena() const noexcept -> Arena* {
+    return arena_;
+  }
+
+  /// Allocate memory for the values.
+  auto allocate(std::size_t count) -> Val* {
+    static_assert(alignof(Val) <= Arena::max_align);
+    if (arena_ == nullptr) return std::allocator<Val>{}.allocate(count);
+    return static_cast<Val*>(
+        arena_->allocate(count * sizeof(Val), alignof(Val)));
+  }
+
+  /// Deallocate memory for the values.
+  void deallocate(Val* ptr, std::size_t count) noexcept {
+    if (arena_ == nullptr) std::allocator<Val>{}.deallocate(ptr, count);
+  }
+
+  /// Compare the allocators.
+  template<class Other>
+  friend constexpr auto operator==(const ArenaAllocator& lhs,
+                                   const ArenaAllocator<Other>& rhs) noexcept
+      -> bool {
+    return lhs.arena() == rhs.arena();
+  }
+
+private:
+
+  Arena* arena_;
+
+}; // class ArenaAllocator
+
+/// Vector that allocates from the current arena.
+template<class Val>
+using ArenaVector = std::vector<Val, ArenaAllocator<Val>>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit
@@ -0,0 +1,104 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "tit/core/arena.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("Arena") {
+  Arena arena;
+  CHECK(arena.capacity() == 0);
+  SUBCASE("alignment") {
+    for (const std::size_t align : {1, 2, 4, 8, 16, 32, 64}) {
+      const auto* const ptr = arena.allocate(3, align);
+      CHECK(std::bit_cast<std::uintptr_t>(ptr) % align == 0);
+    }
+    CHECK(arena.num_chunks() == 1);
+  }
+  SUBCASE("reset") {
+    // Allocations that do not fit into a single chunk create new chunks.
+    arena.allocate(16, 8);
+    arena.allocate(arena.capacity(), 8);
+    REQUIRE(arena.num_chunks() == 2);
+    const auto capacity = arena.capacity();
+
+    // Chunks are merged on reset, and the memory is reused.
+    arena.reset();
+    CHECK(arena.num_chunks() == 1);
+    CHECK(arena.capacity() == capacity);
+    const auto* const first = arena.allocate(16, 8);
+    CHECK(arena.allocate(16, 8) != first);
+    arena.reset();
+    CHECK(arena.allocate(16, 8) == first);
+  }
+  SUBCASE("concurrent") {
+    // Allocations from the different threads must not overlap, including
+    // the ones that trigger the growth of the arena.
+    constexpr std::size_t num_threads = 4;
+    constexpr std::size_t num_allocs = 10000;
+    constexpr std::size_t size = 1000;
+    std::vector<std::vector<std::uintptr_t>> ptrs(num_threads);
+    {
+      std::vector<std::jthread> threads;
+      for (auto& thread_ptrs : ptrs) {
+        threads.emplace_back([&arena, &thread_ptrs] {
+          for (std::size_t i = 0; i < num_allocs; ++i) {
+            thread_ptrs.push_back(
+                std::bit_cast<std::uintptr_t>(arena.allocate(size, 8)));
+          }
+        });
+      }
+    }
+    std::vector<std::uintptr_t> all_ptrs;
+    for (const auto& thread_ptrs : ptrs) {
+      all_ptrs.insert(all_ptrs.end(), thread_ptrs.begin(), thread_ptrs.end());
+    }
+    std::ranges::sort(all_ptrs);
+    REQUIRE(all_ptrs.size() == num_threads * num_allocs);
+    CHECK(std::ranges::adjacent_find(all_ptrs, [](auto a, auto b) {
+            return b - a < size;
+          }) == all_ptrs.end());
+    CHECK(arena.num_chunks() > 1);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("ArenaVector") {
+  Arena arena;
+  SUBCASE("heap") {
+    // Without the scope, the memory is allocated on the heap.
+    const ArenaVector<int> vec(10, 1);
+    CHECK(vec.get_allocator().arena() == nullptr);
+    CHECK(arena.capacity() == 0);
+  }
+  SUBCASE("arena") {
+    const ArenaScope scope{arena};
+    REQUIRE(current_arena() == &arena);
+    ArenaVector<int> vec(10, 1);
+    vec.push_back(2);
+    CHECK(vec.get_allocator().arena() == &arena);
+    CHECK(vec.size() == 11);
+    CHECK(vec.back() == 2);
+    CHECK(arena.capacity() > 0);
+  }
+  CHECK(current_arena() == nullptr);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
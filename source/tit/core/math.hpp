@@ -13,6 +13,7 @@
 #include <limits>
 #include <numbers>
 #include <type_traits>
+#include <utility>
 
 #ifdef __clang__
 #include <gcem.hpp> // IWYU pragma: keep
@@ -131,6 +132,86 @@ constexpr auto avg(Nums... vals) {
   return (vals + ...) / sizeof...(Nums);
 }
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Summation functions.
+//
+
+/// Compensated (Kahan) sum.
+///
+/// Rounding error of each addition is accumulated separately and subtracted
+/// from the subsequent addends, so that the error of the sum does not grow
+/// with the number of addends.
+template<class Val>
+class KahanSum final {
+public:
+
+  /// Construct a sum with the initial value.
+  constexpr explicit KahanSum(Val init = Val{}) noexcept
+      : sum_{std::move(init)} {}
+
+  /// Construct a sum from the running sum and the accumulated error.
+  constexpr KahanSum(Val sum, Val error) noexcept
+      : sum_{std::move(sum)}, error_{std::move(error)} {}
+
+  /// Sum value.
+  constexpr auto value() const noexcept -> Val {
+    return sum_ - error_;
+  }
+
+  /// Running sum, without the error correction.
+  constexpr auto sum() const noexcept -> const Val& {
+    return sum_;
+  }
+
+  /// Accumulated rounding error.
+  constexpr auto error() const noexcept -> const Val& {
+    return error_;
+  }
+
+  /// Add a value to the sum.
+  constexpr auto operator+=(const Val& val) noexcept -> KahanSum& {
+    // Error is computed through the opaque values, so that it is not folded
+    // to zero by the reassociation, which is allowed with `-ffast-math`.
+    // Compiler pragmas are not enough, as they neither affect GCC nor the
+    // inlined operators of the vector types.
+    const auto corrected_val = val - error_;
+    const auto new_sum = sum_ + corrected_val;
+    error_ = opaque_(opaque_(new_sum) - sum_) - corrected_val;
+    sum_ = new_sum;
+    return *this;
+  }
+
+  /// Add another sum to the sum.
+  constexpr auto operator+=(const KahanSum& other) noexcept -> KahanSum& {
+    *this += other.sum_;
+    error_ += other.error_;
+    return *this;
+  }
+
+  /// Add a value or another sum to the sum.
+  template<class Other>
+    requires std::same_as<Other, Val> || std::same_as<Other, KahanSum>
+  friend constexpr auto operator+(KahanSum sum, const Other& other) noexcept
+      -> KahanSum {
+    return sum += other;
+  }
+
+private:
+
+  // Hide the value from the optimizer.
+  static constexpr auto opaque_(Val val) noexcept -> Val {
+    if !consteval {
+      asm volatile("" : "+m"(val)); // NOLINT(*-no-assembler)
+    }
+    return val;
+  }
+
+  Val sum_;
+  Val error_{};
+
+}; // class KahanSum
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //
 // Comparison functions.
@@ -3,10 +3,12 @@
  * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <cstddef>
 #include <limits>
 #include <numbers>
 
 #include "tit/core/math.hpp"
+#include "tit/core/vec.hpp"
 #include "tit/testing/test.hpp"
 
 namespace tit {
@@ -94,6 +96,48 @@ TEST_CASE_TEMPLATE("avg", Float, FLOAT_TYPES) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+TEST_CASE_TEMPLATE("KahanSum", Float, FLOAT_TYPES) {
+  // Each of the addends is lost in the plain summation.
+  constexpr auto eps = std::numeric_limits<Float>::epsilon();
+  constexpr auto tiny = eps / 4;
+  SUBCASE("values") {
+    KahanSum sum{Float{1.0}};
+    for (int i = 0; i < 1000; ++i) sum += tiny;
+    CHECK_APPROX_EQ(sum.value(), Float{1.0} + 1000 * tiny, 10 * eps);
+    // Compensation must survive the optimizations, like `-ffast-math`, which
+    // are allowed to reassociate the error computation into zero.
+    CHECK(sum.value() != Float{1.0});
+  }
+  SUBCASE("vectors") {
+    using Vec4 = Vec<Float, 4>;
+    KahanSum sum{Vec4(Float{1.0})};
+    for (int i = 0; i < 1000; ++i) sum += Vec4(tiny);
+    for (std::size_t i = 0; i < 4; ++i) {
+      CHECK_APPROX_EQ(sum.value()[i], Float{1.0} + 1000 * tiny, 10 * eps);
+    }
+  }
+  SUBCASE("sums") {
+    KahanSum<Float> sum_a{Float{1.0}};
+    KahanSum<Float> sum_b{};
+    for (int i = 0; i < 1000; ++i) sum_b += tiny;
+    CHECK_APPROX_EQ((sum_a + sum_b).value(),
+                    Float{1.0} + 1000 * tiny,
+                    10 * eps);
+  }
+  SUBCASE("restore") {
+    // Sum that is stored as the running sum and the error, and restored
+    // later, continues the compensated summation.
+    KahanSum sum{Float{1.0}};
+    for (int i = 0; i < 1000; ++i) {
+      sum = KahanSum{sum.sum(), sum.error()};
+      sum += tiny;
+    }
+    CHECK_APPROX_EQ(sum.value(), Float{1.0} + 1000 * tiny, 10 * eps);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 TEST_CASE_TEMPLATE("unit_sphere_area_v", Float, FLOAT_TYPES) {
   using std::numbers::pi;
   CHECK_APPROX_EQ(unit_sphere_area_v<1, Float>, Float{2.0});
@@ -0,0 +1,63 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cstddef>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "tit/core/env.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/memory.hpp"
+
+namespace tit {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace {
+
+auto is_huge_(std::size_t size) -> bool {
+  return size >= huge_page_size && huge_pages_enabled();
+}
+
+auto huge_size_(std::size_t size) noexcept -> std::size_t {
+  return divide_up(size, huge_page_size) * huge_page_size;
+}
+
+} // namespace
+
+auto huge_pages_enabled() -> bool {
+  static const bool enabled = get_env("TIT_HUGE_PAGES", false);
+  return enabled;
+}
+
+auto allocate_huge(std::size_t size, std::size_t align) -> void* {
+  if (!is_huge_(size)) return ::operator new(size, std::align_val_t{align});
+
+  // Round the size up to the whole huge pages, so that the tail of the
+  // allocation is backed by a huge page as well.
+  size = huge_size_(size);
+  auto* const ptr = ::operator new(size, std::align_val_t{huge_page_size});
+#ifdef __linux__
+  // Advice fails if the transparent huge pages are disabled system-wide.
+  // This is not an error: the regular pages are used in that case.
+  static_cast<void>(madvise(ptr, size, MADV_HUGEPAGE));
+#endif
+  return ptr;
+}
+
+void deallocate_huge(void* ptr, std::size_t size, std::size_t align) noexcept {
+  if (!is_huge_(size)) {
+    ::operator delete(ptr, size, std::align_val_t{align});
+    return;
+  }
+  ::operator delete(ptr, huge_size_(size), std::align_val_t{huge_page_size});
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit
@@ -0,0 +1,35 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace tit {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Size of the huge memory page.
+inline constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+/// Are the huge pages enabled?
+///
+/// Huge pages are disabled by default, and can be enabled by setting the
+/// `TIT_HUGE_PAGES` environment variable to a non-zero value.
+auto huge_pages_enabled() -> bool;
+
+/// Allocate memory with the specified alignment.
+///
+/// Allocations that span at least a single huge page are aligned to the huge
+/// page boundary, and are advised to be backed by the transparent huge pages.
+/// This reduces the TLB misses when the large arrays are accessed randomly.
+auto allocate_huge(std::size_t size, std::size_t align) -> void*;
+
+/// Deallocate memory that was allocated with `allocate_huge`.
+void deallocate_huge(void* ptr, std::size_t size, std::size_t align) noexcept;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit
@@ -0,0 +1,42 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tit/core/memory.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("allocate_huge") {
+  SUBCASE("small") {
+    constexpr std::size_t size = 100;
+    constexpr std::size_t align = 64;
+    auto* const ptr = allocate_huge(size, align);
+    CHECK(std::bit_cast<std::uintptr_t>(ptr) % align == 0);
+    std::memset(ptr, 0, size);
+    deallocate_huge(ptr, size, align);
+  }
+  SUBCASE("large") {
+    constexpr std::size_t size = 3 * huge_page_size + 1;
+    constexpr std::size_t align = 8;
+    auto* const ptr = allocate_huge(size, align);
+    const auto expected_align = huge_pages_enabled() ? huge_page_size : align;
+    CHECK(std::bit_cast<std::uintptr_t>(ptr) % expected_align == 0);
+    std::memset(ptr, 0, size);
+    deallocate_huge(ptr, size, align);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <functional>
+#include <mutex>
 #include <print>
 #include <ranges>
 #include <string>
@@ -26,6 +27,11 @@ StrHashMap<Stopwatch> Profiler::sections_{};
 
 auto Profiler::section(std::string_view section_name) -> Stopwatch& {
   TIT_ASSERT(!section_name.empty(), "Section name must not be empty!");
+  // Sections may be registered concurrently by the tasks that run in
+  // parallel. References to the map elements are stable, so only the
+  // registration itself is guarded.
+  static std::mutex sections_mutex{};
+  const std::scoped_lock lock{sections_mutex};
   /// @todo There's likely a bug in libstdc++ 16.1 that makes us need to add
   ///       an explicit conversion to `std::string{...}` here.
   return sections_[std::string{section_name}];
@@ -115,6 +115,35 @@ auto cpu_perf_core_frequency() -> std::uint64_t {
   return result_kHz * 1000;
 }
 
+auto numa_nodes() -> std::uint64_t {
+  // Note: kernels without NUMA support do not provide the node information,
+  //       which means that all the memory is local.
+  constexpr const auto* path = "/sys/devices/system/node/online";
+  std::ifstream stream{path};
+  if (!stream.is_open()) return 1;
+
+  // Online nodes are listed as comma-separated ranges, e.g. "0-1,3".
+  std::string line;
+  std::getline(stream, line);
+  std::uint64_t result = 0;
+  for (const auto node_range : std::views::split(line, ',')) {
+    const std::string_view range_str{node_range};
+    const auto dash_pos = range_str.find('-');
+    const auto first = str_to<std::uint64_t>(range_str.substr(0, dash_pos));
+    const auto last = dash_pos == std::string_view::npos ?
+                          first :
+                          str_to<std::uint64_t>(range_str.substr(dash_pos + 1));
+    TIT_ENSURE(first.has_value() && last.has_value() && *first <= *last,
+               "Invalid NUMA node range '{}' in '{}'.",
+               range_str,
+               path);
+    result += *last - *first + 1;
+  }
+
+  TIT_ENSURE(result > 0, "Cannot find any NUMA nodes in '{}'.", path);
+  return result;
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace tit::sys_info
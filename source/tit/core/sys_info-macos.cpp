@@ -78,6 +78,12 @@ auto cpu_perf_core_frequency() -> std::uint64_t {
   }
 }
 
+auto numa_nodes() -> std::uint64_t {
+  // Note: macOS does not expose the NUMA topology, and Apple machines have
+  //       the unified memory anyway.
+  return 1;
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace tit::sys_info
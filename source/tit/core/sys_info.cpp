@@ -79,6 +79,9 @@ auto cpu_info() -> std::string {
                             fmt_quantity(cpu_perf_core_frequency(), "Hz"),
                             cpu_arch());
   if (num_sockets > 1) result = std::format("{} × {}", num_sockets, result);
+  if (const auto num_nodes = numa_nodes(); num_nodes > 1) {
+    result = std::format("{}, {} NUMA nodes", result, num_nodes);
+  }
   return result;
 }
 
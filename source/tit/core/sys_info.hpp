@@ -46,6 +46,9 @@ auto cpu_perf_cores() -> std::uint64_t;
 /// Get CPU frequency in Hz.
 auto cpu_perf_core_frequency() -> std::uint64_t;
 
+/// Get number of NUMA nodes.
+auto numa_nodes() -> std::uint64_t;
+
 /// Get overall CPU information.
 auto cpu_info() -> std::string;
 
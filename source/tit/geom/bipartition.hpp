@@ -6,21 +6,93 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <functional>
 #include <iterator>
 #include <ranges>
 #include <span>
+#include <type_traits>
 #include <utility>
 
 #include "tit/core/assert.hpp"
 #include "tit/core/vec.hpp"
 #include "tit/geom/point_range.hpp"
+#include "tit/par/algorithms.hpp"
 
 namespace tit::geom {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+namespace impl {
+
+// Minimal number of points to be split in parallel.
+inline constexpr std::size_t min_par_split_size = 16384;
+
+// Partition the permutation. Large permutations are partitioned in parallel.
+template<class Pred, class Proj>
+auto partition_perm(std::span<std::size_t> perm, Pred pred, Proj proj)
+    -> std::span<std::size_t> {
+  if (perm.size() >= min_par_split_size) {
+    return par::partition(perm, std::move(pred), std::move(proj));
+  }
+  return std::ranges::partition(perm, std::move(pred), std::move(proj));
+}
+
+// Rearrange the permutation such that the element at the given position is
+// the one that would be there if the permutation was sorted by the key, all
+// the preceding elements have no greater keys, and all the following elements
+// have no lesser keys. Large permutations are narrowed down using the parallel
+// three-way partitioning around the sample median, and the remainder is
+// processed serially.
+template<class Key>
+void par_nth_element(std::span<std::size_t> perm, std::size_t nth, Key key) {
+  TIT_ASSERT(nth < perm.size(), "Index is out of range!");
+  while (perm.size() >= min_par_split_size) {
+    // Choose the pivot as the median of the evenly spaced sample.
+    static constexpr std::size_t SampleSize = 63;
+    std::array<std::invoke_result_t<Key&, std::size_t>, SampleSize> sample{};
+    const auto sample_stride = perm.size() / SampleSize;
+    for (std::size_t i = 0; i < SampleSize; ++i) {
+      sample[i] = std::invoke(key, perm[i * sample_stride]);
+    }
+    const auto sample_median = std::next(sample.begin(), SampleSize / 2);
+    std::ranges::nth_element(sample, sample_median);
+    const auto pivot = *sample_median;
+
+    // Split the permutation into the elements with the keys that are less,
+    // equal and greater than the pivot.
+    const std::span<std::size_t> equal_perm =
+        par::partition(perm, std::bind_back(std::less{}, pivot), key);
+    const std::span<std::size_t> greater_perm =
+        par::partition(equal_perm,
+                       std::bind_back(std::less_equal{}, pivot),
+                       key);
+    const auto equal_offset = perm.size() - equal_perm.size();
+    const auto greater_offset = perm.size() - greater_perm.size();
+
+    // Continue with the part that contains the requested element. If the
+    // element falls into the equal part, we are done.
+    if (nth < equal_offset) {
+      perm = perm.first(equal_offset);
+    } else if (nth >= greater_offset) {
+      perm = greater_perm;
+      nth -= greater_offset;
+    } else {
+      return;
+    }
+  }
+  std::ranges::nth_element(
+      perm,
+      std::next(perm.begin(), static_cast<std::ptrdiff_t>(nth)),
+      std::less{},
+      std::move(key));
+}
+
+} // namespace impl
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 /// Coordinate bisection function.
 class CoordBisection final {
 public:
@@ -36,12 +108,12 @@ public:
     TIT_ASSERT(axis < point_range_dim_v<Points>, "Axis is out of range!");
     std::span<std::size_t> right_perm;
     if (reverse) {
-      right_perm = std::ranges::partition(
+      right_perm = impl::partition_perm(
           perm,
           std::bind_back(std::greater{}, pivot),
           [&points, axis](std::size_t index) { return points[index][axis]; });
     } else {
-      right_perm = std::ranges::partition(
+      right_perm = impl::partition_perm(
           perm,
           std::bind_back(std::less{}, pivot),
           [&points, axis](std::size_t index) { return points[index][axis]; });
@@ -73,17 +145,17 @@ public:
       -> std::pair<std::span<std::size_t>, std::span<std::size_t>> {
     std::span<std::size_t> right_perm;
     if (reverse) {
-      right_perm = std::ranges::partition(perm,
-                                          std::bind_back(std::greater{}, pivot),
-                                          [&points, &dir](std::size_t index) {
-                                            return dot(points[index], dir);
-                                          });
+      right_perm = impl::partition_perm(perm,
+                                        std::bind_back(std::greater{}, pivot),
+                                        [&points, &dir](std::size_t index) {
+                                          return dot(points[index], dir);
+                                        });
     } else {
-      right_perm = std::ranges::partition(perm,
-                                          std::bind_back(std::less{}, pivot),
-                                          [&points, &dir](std::size_t index) {
-                                            return dot(points[index], dir);
-                                          });
+      right_perm = impl::partition_perm(perm,
+                                        std::bind_back(std::less{}, pivot),
+                                        [&points, &dir](std::size_t index) {
+                                          return dot(points[index], dir);
+                                        });
     }
     return {
         {std::ranges::begin(perm), std::ranges::begin(right_perm)},
@@ -113,11 +185,14 @@ public:
     TIT_ASSERT(axis < point_range_dim_v<Points>, "Axis is out of range!");
     const auto median =
         std::next(perm.begin(), static_cast<std::ptrdiff_t>(median_index));
-    std::ranges::nth_element(
-        perm,
-        median,
-        std::less{},
-        [&points, axis](std::size_t index) { return points[index][axis]; });
+    const auto coord = [&points, axis](std::size_t index) {
+      return points[index][axis];
+    };
+    if (perm.size() >= impl::min_par_split_size) {
+      impl::par_nth_element(perm, median_index, coord);
+    } else {
+      std::ranges::nth_element(perm, median, std::less{}, coord);
+    }
     return {
         {std::ranges::begin(perm), median},
         {median, std::ranges::end(perm)},
@@ -157,12 +232,14 @@ public:
       -> std::pair<std::span<std::size_t>, std::span<std::size_t>> {
     const auto median =
         std::next(perm.begin(), static_cast<std::ptrdiff_t>(median_index));
-    std::ranges::nth_element( //
-        perm,
-        median,
-        [&points, &dir](std::size_t i, std::size_t j) {
-          return dot(points[i] - points[j], dir) < 0;
-        });
+    const auto proj = [&points, &dir](std::size_t index) {
+      return dot(points[index], dir);
+    };
+    if (perm.size() >= impl::min_par_split_size) {
+      impl::par_nth_element(perm, median_index, proj);
+    } else {
+      std::ranges::nth_element(perm, median, std::less{}, proj);
+    }
     return {
         {std::ranges::begin(perm), median},
         {median, std::ranges::end(perm)},
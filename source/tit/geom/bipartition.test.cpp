@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <numeric>
 #include <utility>
+#include <vector>
 
 #include "tit/core/vec.hpp"
 #include "tit/geom/bipartition.hpp"
@@ -147,6 +148,34 @@ TEST_CASE("geom::DirMedianSplit") {
   CHECK_RANGE_EQ(right_perm, {3, 6, 7, 9, 10, 11, 12, 13, 14, 15});
 }
 
+TEST_CASE("geom::DirMedianSplit[large]") {
+  // Create points on a 200x200 lattice, which is large enough for the
+  // parallel split.
+  constexpr std::size_t side = 200;
+  std::vector<Vec2D> points(side * side);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    points[i] = {i % side, i / side};
+  }
+
+  // Initialize the permutation.
+  std::vector<std::size_t> perm(points.size());
+  std::ranges::iota(perm, std::size_t{0});
+
+  // Partition the points.
+  const auto dir = normalize(Vec2D{1, 2});
+  const auto median_index = perm.size() / 3;
+  const auto [left_perm, right_perm] =
+      geom::dir_median_split(points, perm, median_index, dir);
+
+  // Ensure the result is split by the projection onto the direction.
+  const auto proj = [&points, &dir](std::size_t i) {
+    return dot(points[i], dir);
+  };
+  REQUIRE(left_perm.size() == median_index);
+  CHECK(proj(std::ranges::max(left_perm, {}, proj)) <=
+        proj(std::ranges::min(right_perm, {}, proj)));
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 TEST_CASE("geom::InertialMedianSplit") {
@@ -10,7 +10,6 @@
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
-#include <numeric>
 #include <ranges>
 #include <vector>
 
@@ -53,27 +52,26 @@ public:
     const auto box = compute_bbox(surf_->verts()).grow(size_hint / 2);
     grid_ = Grid{box}.set_cell_extents(size_hint);
 
-    // Count the faces intersecting each cell. Counts are shifted by two so
+    // Count the faces intersecting each cell. Counts are shifted by one so
     // that the fill positions turn into the final cell offsets in-place.
-    cell_face_offsets_.resize(grid_.flat_num_cells() + 2);
+    cell_face_offsets_.resize(grid_.flat_num_cells() + 1);
     par::for_each(face_indices, [this](std::size_t face_index) {
       for (const auto& cell :
            grid_.cells_intersecting(surf_->face(face_index).box())) {
         const auto flat_cell = grid_.flatten_cell_index(cell);
         TIT_ASSERT(flat_cell < grid_.flat_num_cells(),
                    "Cell index is out of range!");
-        par::fetch_and_add(cell_face_offsets_[flat_cell + 2], 1);
+        par::fetch_and_add(cell_face_offsets_[flat_cell + 1], 1);
       }
     });
 
     // Convert the cell counts to offsets and allocate the face indices.
-    std::partial_sum(cell_face_offsets_.begin() + 2,
-                     cell_face_offsets_.end(),
-                     cell_face_offsets_.begin() + 2);
-    cell_faces_.resize(cell_face_offsets_.back());
+    const auto cell_counts = cell_face_offsets_ | std::views::drop(1);
+    cell_faces_.resize(
+        par::exclusive_scan(cell_counts, std::ranges::begin(cell_counts)));
 
     // Fill each cell range in parallel. Incrementing the shifted offsets
-    // leaves the final CSR offsets in the first `num_cells + 1` entries.
+    // leaves the final CSR offsets in-place.
     par::for_each(face_indices, [this](std::size_t face_index) {
       for (const auto& cell :
            grid_.cells_intersecting(surf_->face(face_index).box())) {
@@ -85,7 +83,6 @@ public:
         cell_faces_[position] = face_index;
       }
     });
-    cell_face_offsets_.pop_back();
   }
 
   /// Find the faces intersecting the given sphere.
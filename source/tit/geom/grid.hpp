@@ -127,6 +127,19 @@ public:
     return flat_index;
   }
 
+  /// Index of the cell with the given flat index.
+  constexpr auto unflatten_cell_index(std::size_t flat_index) const
+      -> VecIndex {
+    TIT_ASSERT(flat_index < flat_num_cells(), "Flat index is out of bounds!");
+    VecIndex index;
+    for (std::size_t i = vec_dim_v<Vec> - 1; i > 0; --i) {
+      index[i] = flat_index % num_cells_[i];
+      flat_index /= num_cells_[i];
+    }
+    index[0] = flat_index;
+    return index;
+  }
+
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   /// Range of all cell indices.
@@ -112,6 +112,17 @@ TEST_CASE("geom::Grid::cell_index") {
   CHECK(grid.flatten_cell_index({1, 1}) == 3);
 }
 
+TEST_CASE("geom::Grid::unflatten_cell_index") {
+  const geom::BBox box{Vec{0.0, 0.0, 0.0}, Vec{4.0, 3.0, 2.0}};
+  const geom::Grid grid{box, {4, 3, 2}};
+  for (const auto& cell : grid.cells()) {
+    CHECK(grid.unflatten_cell_index(grid.flatten_cell_index(cell)) == cell);
+  }
+  CHECK(grid.unflatten_cell_index(0) == Vec{0UZ, 0UZ, 0UZ});
+  CHECK(grid.unflatten_cell_index(7) == Vec{1UZ, 0UZ, 1UZ});
+  CHECK(grid.unflatten_cell_index(23) == Vec{3UZ, 2UZ, 1UZ});
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 TEST_CASE("geom::Grid::cells") {
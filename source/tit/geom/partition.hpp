@@ -14,6 +14,7 @@
 #include "tit/geom/partition/pixelated_partition.hpp"
 #include "tit/geom/partition/recursive_bisection.hpp"
 #include "tit/geom/partition/sort_partition.hpp"
+#include "tit/geom/partition/sparse_pixelated_partition.hpp"
 // IWYU pragma: end_exports
 
 namespace tit::geom {
@@ -25,7 +26,8 @@ template<class PF>
 concept partition_func = std::same_as<PF, KMeansClustering> ||
                          specialization_of<PF, PixelatedPartition> ||
                          specialization_of<PF, RecursiveBisection> ||
-                         specialization_of<PF, SortPartition>;
+                         specialization_of<PF, SortPartition> ||
+                         specialization_of<PF, SparsePixelatedPartition>;
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -10,8 +10,8 @@
 #include <limits>
 #include <random>
 #include <ranges>
-#include <vector>
 
+#include "tit/core/arena.hpp"
 #include "tit/core/assert.hpp"
 #include "tit/core/float.hpp"
 #include "tit/core/math.hpp"
@@ -62,8 +62,8 @@ public:
 
     // Compute the initial centroids (K-means++ initialization).
     std::mt19937_64 rng{num_points};
-    std::vector min_sq_dists(num_points, std::numeric_limits<Num>::max());
-    std::vector<Vec> centroids(num_clusters);
+    ArenaVector<Num> min_sq_dists(num_points, std::numeric_limits<Num>::max());
+    ArenaVector<Vec> centroids(num_clusters);
     std::uniform_int_distribution points_dist(0UZ, num_points - 1);
     centroids.front() = points[points_dist(rng)];
     for (auto&& [prev_centroid, centroid] : std::views::pairwise(centroids)) {
@@ -89,8 +89,8 @@ public:
     std::ranges::sort(centroids, {}, [](const Vec& p) { return p.elems(); });
 
     // Run K-means algorithm.
-    std::vector<Vec> prev_centroids(num_clusters);
-    std::vector<std::size_t> cluster_counts(num_clusters);
+    ArenaVector<Vec> prev_centroids(num_clusters);
+    ArenaVector<std::size_t> cluster_counts(num_clusters);
     for (std::size_t iter = 0; iter < max_iters_; ++iter) {
       // Assign points to the closest centroid.
       std::ranges::fill(cluster_counts, 0);
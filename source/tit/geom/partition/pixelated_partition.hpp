@@ -9,8 +9,8 @@
 #include <cstddef>
 #include <limits>
 #include <ranges>
-#include <vector>
 
+#include "tit/core/arena.hpp"
 #include "tit/core/assert.hpp"
 #include "tit/core/mdvector.hpp"
 #include "tit/core/profiler.hpp"
@@ -71,7 +71,7 @@ public:
       const auto pixel_coords = grid.cell_index(point);
       pixels[pixel_coords.elems()].active = true;
     }
-    std::vector<point_range_vec_t<Points>> pixelated_points;
+    ArenaVector<point_range_vec_t<Points>> pixelated_points;
     for (const auto& pixel_coords : grid.cells()) {
       auto& [index, active] = pixels[pixel_coords.elems()];
       if (active) {
@@ -82,7 +82,7 @@ public:
     }
 
     // Partition the pixel grid using the partitioning function.
-    std::vector<std::ranges::range_value_t<Parts>> pixelated_parts(
+    ArenaVector<std::ranges::range_value_t<Parts>> pixelated_parts(
         pixelated_points.size());
     partition_(pixelated_points, pixelated_parts, num_parts, init_part);
 
@@ -15,6 +15,7 @@
 #include "tit/core/range.hpp"
 #include "tit/geom/point_range.hpp"
 #include "tit/geom/sort.hpp"
+#include "tit/par/algorithms.hpp"
 
 namespace tit::geom {
 
@@ -55,17 +56,22 @@ public:
     sort_(points, perm);
 
     // Assign the partitions.
+    using Part = std::ranges::range_value_t<Parts>;
     const auto part_size = num_points / num_parts;
     const auto remainder = num_points % num_parts;
-    for (std::ranges::range_value_t<Parts> part = 0; part < num_parts; ++part) {
-      const auto first = part * part_size + //
-                         std::min(static_cast<std::size_t>(part), remainder);
-      const auto last = (part + 1) * part_size +
-                        std::min(static_cast<std::size_t>(part + 1), remainder);
-      for (std::size_t i = first; i < last; ++i) {
-        parts[perm[i]] = init_part + part;
-      }
-    }
+    par::for_each(
+        std::views::iota(Part{0}, num_parts),
+        [&parts, &perm, part_size, remainder, init_part](Part part) {
+          const auto first =
+              part * part_size +
+              std::min(static_cast<std::size_t>(part), remainder);
+          const auto last =
+              (part + 1) * part_size +
+              std::min(static_cast<std::size_t>(part + 1), remainder);
+          for (std::size_t i = first; i < last; ++i) {
+            parts[perm[i]] = init_part + part;
+          }
+        });
   }
 
 private:
@@ -92,6 +98,18 @@ using MortonCurvePartition = SortPartition<MortonCurveSort>;
 /// Morton curve sort based partitioning.
 inline constexpr MortonCurvePartition morton_curve_partition{};
 
+/// Hilbert curve key sort based partitioning function.
+using HilbertKeyPartition = SortPartition<HilbertKeySort>;
+
+/// Hilbert curve key sort based partitioning.
+inline constexpr HilbertKeyPartition hilbert_key_partition{};
+
+/// Morton curve key sort based partitioning function.
+using MortonKeyPartition = SortPartition<MortonKeySort>;
+
+/// Morton curve key sort based partitioning.
+inline constexpr MortonKeyPartition morton_key_partition{};
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace tit::geom
@@ -0,0 +1,123 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+
+#include "tit/core/arena.hpp"
+#include "tit/core/assert.hpp"
+#include "tit/core/profiler.hpp"
+#include "tit/core/range.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/grid.hpp"
+#include "tit/geom/point_range.hpp"
+#include "tit/par/algorithms.hpp"
+
+namespace tit::geom {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Sparse pixelated partitioning function.
+///
+/// Unlike the `PixelatedPartition`, only the active pixels are stored, as
+/// a sorted set of the flat pixel indices. Memory consumption therefore scales
+/// with the number of active pixels, rather than with the volume of the
+/// bounding box.
+template<class Num, class Partition>
+class SparsePixelatedPartition final {
+public:
+
+  /// Construct a sparse pixelated partitioning function.
+  ///
+  /// @param size_hint Pixel size, typically 2x of the particle spacing.
+  /// @param partition Partitioning function.
+  constexpr explicit SparsePixelatedPartition(Num size_hint,
+                                              Partition partition) noexcept
+      : size_hint_{size_hint}, partition_{partition} {
+    TIT_ASSERT(size_hint_ > 0.0, "Cell size hint must be positive!");
+  }
+
+  /// Partition the points using the grid graph partitioning algorithm.
+  template<point_range Points, output_index_range Parts>
+    requires std::same_as<point_range_num_t<Points>, Num>
+  void operator()(Points&& points,
+                  Parts&& parts,
+                  std::ranges::range_value_t<Parts> num_parts,
+                  std::ranges::range_value_t<Parts> init_part = 0) const {
+    TIT_PROFILE_SECTION("SparsePixelatedPartition::operator()");
+
+    // Validate the arguments.
+    TIT_ASSERT(num_parts > 0, "Number of parts must be positive!");
+    TIT_ASSERT(std::ranges::size(points) >= num_parts,
+               "Number of points cannot be less than the number of parts!");
+    if constexpr (std::ranges::sized_range<Parts>) {
+      TIT_ASSERT(std::ranges::size(points) == std::ranges::size(parts),
+                 "Size of parts range must be equal to the number of points!");
+    }
+
+    // Compute bounding box and initialize the pixel grid.
+    const auto box = compute_bbox(points).grow(size_hint_ / 2);
+    const auto grid = Grid{box}.set_cell_extents(size_hint_);
+
+    // Compute the flat pixel index of each point.
+    const auto num_points = std::ranges::size(points);
+    const auto point_indices = std::views::iota(std::size_t{0}, num_points);
+    ArenaVector<std::size_t> point_pixels(num_points);
+    par::for_each(point_indices,
+                  [&points, &point_pixels, &grid](std::size_t index) {
+                    point_pixels[index] = grid.flat_cell_index(points[index]);
+                  });
+
+    // Identify the active pixels: sort the pixel indices and drop the
+    // duplicates. Position of a pixel in the resulting sorted array is its
+    // index in the pixelated point set.
+    auto pixels = point_pixels;
+    par::sort(pixels);
+    pixels.erase(std::ranges::unique(pixels).begin(), pixels.end());
+
+    // Collect the active pixel coordinates.
+    ArenaVector<point_range_vec_t<Points>> pixelated_points(pixels.size());
+    par::for_each(std::views::zip(pixels, pixelated_points),
+                  [&grid](auto pixel_and_point) {
+                    auto&& [pixel, point] = pixel_and_point;
+                    point = vec_cast<point_range_num_t<Points>>(
+                        grid.unflatten_cell_index(pixel));
+                  });
+
+    // Partition the pixel grid using the partitioning function.
+    ArenaVector<std::ranges::range_value_t<Parts>> pixelated_parts(
+        pixelated_points.size());
+    partition_(pixelated_points, pixelated_parts, num_parts, init_part);
+
+    // Scatter the final part indices back to the points.
+    par::for_each(
+        point_indices,
+        [&parts, &pixels, &point_pixels, &pixelated_parts](std::size_t index) {
+          const auto pixel_iter =
+              std::ranges::lower_bound(pixels, point_pixels[index]);
+          TIT_ASSERT(pixel_iter != pixels.end() &&
+                         *pixel_iter == point_pixels[index],
+                     "Pixel is not found!");
+          const auto pixel_index = static_cast<std::size_t>(
+              std::distance(pixels.begin(), pixel_iter));
+          parts[index] = pixelated_parts[pixel_index];
+        });
+  }
+
+private:
+
+  Num size_hint_;
+  [[no_unique_address]] Partition partition_;
+
+}; // class SparsePixelatedPartition
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::geom
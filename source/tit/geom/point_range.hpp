@@ -10,12 +10,14 @@
 #include <iterator>
 #include <ranges>
 #include <span>
+#include <utility>
 
 #include "tit/core/assert.hpp"
 #include "tit/core/mat.hpp"
 #include "tit/core/range.hpp"
 #include "tit/core/vec.hpp"
 #include "tit/geom/bbox.hpp"
+#include "tit/par/algorithms.hpp"
 
 namespace tit::geom {
 
@@ -57,11 +59,29 @@ constexpr auto count_points(Points&& points) -> point_range_num_t<Points> {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+namespace impl {
+
+// Minimal number of points to be processed in parallel.
+inline constexpr std::size_t min_par_num_points = 4096;
+
+} // namespace impl
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 /// Compute the centroid of the given non-empty point range.
 /// @{
 template<point_range Points>
 constexpr auto compute_center(Points&& points) -> point_range_vec_t<Points> {
   TIT_ASSERT(!std::ranges::empty(points), "Points must not be empty!");
+  if !consteval {
+    if (std::ranges::size(points) >= impl::min_par_num_points) {
+      // Parallel algorithms require a common range, which point ranges are
+      // not guaranteed to be.
+      const auto sum = par::deterministic_fold(std::views::common(points),
+                                               point_range_vec_t<Points>{});
+      return sum / count_points(points);
+    }
+  }
   auto sum = *std::ranges::begin(points);
   for (const auto& point : points | std::views::drop(1)) sum += point;
   return sum / count_points(points);
@@ -82,6 +102,23 @@ template<point_range Points>
 constexpr auto compute_bbox(Points&& points) -> point_range_bbox_t<Points> {
   TIT_ASSERT(!std::ranges::empty(points), "Points must not be empty!");
   BBox box{*std::ranges::begin(points)};
+  if !consteval {
+    if (std::ranges::size(points) >= impl::min_par_num_points) {
+      // Bounding box computation is exact, so it is safe to use the
+      // non-deterministic parallel fold.
+      return par::fold(
+          std::views::common(points),
+          std::move(box),
+          [](auto partial_box, const auto& point) {
+            partial_box.expand(point);
+            return partial_box;
+          },
+          [](auto partial_box, const auto& other_box) {
+            partial_box.join(other_box);
+            return partial_box;
+          });
+    }
+  }
   for (const auto& point : points | std::views::drop(1)) box.expand(point);
   return box;
 }
@@ -103,6 +140,27 @@ template<point_range Points>
 constexpr auto compute_inertia_tensor(Points&& points)
     -> point_range_mat_t<Points> {
   TIT_ASSERT(!std::ranges::empty(points), "Points must not be empty!");
+  if !consteval {
+    if (std::ranges::size(points) >= impl::min_par_num_points) {
+      using Moments = std::pair<point_range_vec_t<Points>, //
+                                point_range_mat_t<Points>>;
+      const auto [sum, sum_sqr] = par::deterministic_fold(
+          std::views::common(points),
+          Moments{},
+          [](Moments moments, const auto& point) {
+            moments.first += point;
+            moments.second += outer_sqr(point);
+            return moments;
+          },
+          [](Moments moments, const Moments& other_moments) {
+            moments.first += other_moments.first;
+            moments.second += other_moments.second;
+            return moments;
+          });
+      const auto center = sum / count_points(points);
+      return sum_sqr - outer(sum, center);
+    }
+  }
   auto sum = *std::ranges::begin(points);
   auto inertia_tensor = outer_sqr(sum);
   for (const auto& point : points | std::views::drop(1)) {
@@ -5,6 +5,7 @@
 
 #include <array>
 #include <cstddef>
+#include <vector>
 
 #include "tit/core/mat.hpp"
 #include "tit/core/vec.hpp"
@@ -19,6 +20,14 @@ using Vec2D = Vec<double, 2>;
 using Mat2D = Mat<double, 2>;
 using Box2D = geom::BBox<Vec2D>;
 
+// Create the points on a diagonal line. Number of points is large enough for
+// the computations to run in parallel.
+auto make_diagonal_points() -> std::vector<Vec2D> {
+  std::vector<Vec2D> points(10000);
+  for (std::size_t i = 0; i < points.size(); ++i) points[i] = {i, i};
+  return points;
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 TEST_CASE("geom::count_points") {
@@ -44,6 +53,10 @@ TEST_CASE("geom::compute_center") {
     constexpr auto perm = std::to_array<std::size_t>({1, 2, 0});
     CHECK(geom::compute_center(points, perm) == expected_center);
   }
+  SUBCASE("large") {
+    const auto large_points = make_diagonal_points();
+    CHECK(geom::compute_center(large_points) == Vec2D{4999.5, 4999.5});
+  }
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -62,6 +75,12 @@ TEST_CASE("geom::compute_bbox") {
     CHECK(box.low() == expected_bbox.low());
     CHECK(box.high() == expected_bbox.high());
   }
+  SUBCASE("large") {
+    const auto large_points = make_diagonal_points();
+    const auto box = geom::compute_bbox(large_points);
+    CHECK(box.low() == Vec2D{0, 0});
+    CHECK(box.high() == Vec2D{9999, 9999});
+  }
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -78,6 +97,13 @@ TEST_CASE("geom::compute_inertia_tensor") {
     const auto tensor = geom::compute_inertia_tensor(points, perm);
     CHECK(tensor == expected_tensor);
   }
+  SUBCASE("large") {
+    // Sum of the squared distances to the center is N(N²-1)/12.
+    const auto large_points = make_diagonal_points();
+    const auto tensor = geom::compute_inertia_tensor(large_points);
+    constexpr auto sum_sqr = 83333332500.0;
+    CHECK(tensor == Mat2D{{sum_sqr, sum_sqr}, {sum_sqr, sum_sqr}});
+  }
 }
 
 TEST_CASE("geom::compute_largest_inertia_axis") {
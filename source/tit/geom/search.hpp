@@ -10,6 +10,7 @@
 #include "tit/core/type.hpp"
 
 // IWYU pragma: begin_exports
+#include "tit/geom/search/bucket_kd_tree_search.hpp"
 #include "tit/geom/search/grid_search.hpp"
 #include "tit/geom/search/kd_tree_search.hpp"
 // IWYU pragma: end_exports
@@ -21,7 +22,8 @@ namespace tit::geom {
 /// Spatial search indexing function type.
 template<class SF>
 concept search_func = specialization_of<SF, GridSearch> || //
-                      std::same_as<SF, KDTreeSearch>;
+                      std::same_as<SF, KDTreeSearch> ||     //
+                      std::same_as<SF, BucketKDTreeSearch>;
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
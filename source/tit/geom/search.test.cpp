@@ -99,6 +99,28 @@ auto search_kd_tree(const std::vector<Vec>& points,
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+// Nearest neighbor search via a bucketed K-dimensional tree.
+template<class Vec>
+auto search_bucket_kd_tree(const std::vector<Vec>& points,
+                           vec_num_t<Vec> search_radius,
+                           std::size_t bucket_size) -> SearchResult {
+  // Construct the bucketed K-dimensional tree.
+  const geom::BucketKDTreeSearch bucket_kd_tree_search{bucket_size};
+  const auto bucket_kd_tree_index = bucket_kd_tree_search(points);
+
+  // Perform the nearest neighbor search.
+  SearchResult result(points.size());
+  par::set_num_threads(4);
+  par::for_each(std::views::zip(points, result), [&](auto&& pair) {
+    auto&& [point, result_row] = pair;
+    bucket_kd_tree_index.search(geom::BSphere{point, search_radius},
+                                std::back_inserter(result_row));
+  });
+  return result;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 // Run a search test.
 template<class Vec>
 void run_search_test(const std::vector<Vec>& points,
@@ -123,6 +145,15 @@ void run_search_test(const std::vector<Vec>& points,
   INFO("KD tree search");
   const auto result_kd_tree = search_kd_tree(points, search_radius);
   CHECK(match_search_results(result_naive, result_kd_tree));
+
+  // Nearest neighbor search with a bucketed K-dimensional tree.
+  INFO("Bucketed KD tree search");
+  for (const std::size_t bucket_size : {2, 16, 32}) {
+    CAPTURE(bucket_size);
+    const auto result_bucket_kd_tree =
+        search_bucket_kd_tree(points, search_radius, bucket_size);
+    CHECK(match_search_results(result_naive, result_bucket_kd_tree));
+  }
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -0,0 +1,263 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <inplace_vector>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "tit/core/assert.hpp"
+#include "tit/core/exception.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/profiler.hpp"
+#include "tit/core/type.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/bipartition.hpp"
+#include "tit/geom/bsphere.hpp"
+#include "tit/geom/point_range.hpp"
+#include "tit/par/algorithms.hpp"
+#include "tit/par/atomic.hpp"
+#include "tit/par/task_group.hpp"
+
+namespace tit::geom {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Maximal number of points in a leaf bucket of the bucketed K-dimensional
+/// tree.
+inline constexpr std::size_t max_kd_tree_bucket_size = 32;
+
+/// Bucketed K-dimensional tree spatial search index.
+///
+/// Unlike the `KDTreeIndex`, leaves of the tree hold buckets of points, which
+/// coordinates are stored contiguously in the structure-of-arrays layout, so
+/// that the distance tests inside the leaves are vectorized. Tree nodes are
+/// compact and use 32-bit indices, and the tree is traversed iteratively.
+template<point_range Points>
+  requires std::ranges::view<Points>
+class BucketKDTreeIndex final {
+public:
+
+  /// Point type.
+  using Vec = point_range_vec_t<Points>;
+
+  /// Maximal number of points in a leaf bucket.
+  static constexpr std::size_t max_bucket_size = max_kd_tree_bucket_size;
+
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  /// Index the points for search using a bucketed K-dimensional tree.
+  ///
+  /// @param bucket_size Number of points in a leaf bucket, up to 32.
+  explicit BucketKDTreeIndex(Points points, std::size_t bucket_size = 16)
+      : points_{std::move(points)} {
+    TIT_ASSERT(bucket_size > 1 && bucket_size <= max_bucket_size,
+               "Bucket size is out of range!");
+    if (std::ranges::empty(points_)) return;
+    const auto num_points = std::ranges::size(points_);
+    TIT_ENSURE(num_points < npos_,
+               "Number of points exceeds the limit of {}.",
+               npos_);
+
+    // Initialize the permutation.
+    perm_.resize(num_points);
+    std::ranges::iota(perm_, std::size_t{0});
+
+    // Initialize the node storage. Each leaf holds at least a half of the
+    // bucket, which bounds the number of the nodes.
+    nodes_.resize(2 * divide_up(num_points, bucket_size / 2));
+    std::uint32_t node_counter = 0;
+
+    // Recursively construct the tree. Median splits rearrange the permutation
+    // in-place, so that the points of each leaf end up contiguous.
+    par::TaskGroup tasks{};
+    [&my_points = points_,
+     &nodes = nodes_,
+     &node_counter,
+     &tasks,
+     perm_data = perm_.data(),
+     bucket_size](this const auto& self,
+                  std::span<std::size_t> my_perm) -> std::uint32_t {
+      // Allocate the node.
+      const auto node_index = par::fetch_and_add(node_counter, 1);
+      TIT_ASSERT(node_index < nodes.size(), "Node storage is exhausted!");
+      auto& node = nodes[node_index];
+
+      // Make a leaf if the bucket is small enough.
+      if (my_perm.size() <= bucket_size) {
+        node.axis = leaf_axis_;
+        const auto offset = my_perm.data() - perm_data;
+        node.first = static_cast<std::uint32_t>(offset);
+        node.second = static_cast<std::uint32_t>(offset + my_perm.ssize());
+        return node_index;
+      }
+
+      // Split the points into the roughly equal halves. Points of the left
+      // half have no greater coordinates than the split coordinate, and points
+      // of the right half have no lesser coordinates.
+      const auto box = compute_bbox(my_points, my_perm);
+      const auto axis = max_value_index(box.extents());
+      const auto median_index = my_perm.size() / 2;
+      const auto [left_perm, right_perm] =
+          coord_median_split(my_points, my_perm, median_index, axis);
+      node.axis = static_cast<std::uint32_t>(axis);
+      node.split = my_points[my_perm[median_index]][axis];
+
+      // Recursively partition the halves.
+      constexpr std::size_t min_par_size = 50;
+      using enum par::RunMode;
+      tasks.run([&node, left_perm, self] { node.first = self(left_perm); },
+                std::ranges::size(left_perm) >= min_par_size ? parallel :
+                                                               sequential);
+      tasks.run([&node, right_perm, self] { node.second = self(right_perm); },
+                std::ranges::size(right_perm) >= min_par_size ? parallel :
+                                                                sequential);
+      return node_index;
+    }(perm_);
+    tasks.wait();
+    nodes_.resize(node_counter);
+
+    // Store the point coordinates in the leaf order.
+    for (auto& coords : coords_) coords.resize(num_points);
+    par::for_each(std::views::iota(std::size_t{0}, num_points),
+                  [this](std::size_t i) {
+                    const auto& point = points_[perm_[i]];
+                    for (std::size_t d = 0; d < Dim_; ++d) {
+                      coords_[d][i] = point[d];
+                    }
+                  });
+  }
+
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  /// Find the points within the given sphere.
+  template<std::output_iterator<std::size_t> OutIter>
+  auto search(const BSphere<Vec>& search_sphere, OutIter out) const -> OutIter {
+    if (nodes_.empty()) return out;
+    const auto& center = search_sphere.center();
+    const auto radius_sqr = pow2(search_sphere.radius());
+
+    // Traverse the tree, nearest subtrees first.
+    std::inplace_vector<std::uint32_t, max_depth_> stack{0};
+    while (!stack.empty()) {
+      const auto& node = nodes_[stack.back()];
+      stack.pop_back();
+
+      // Test the points of the leaf bucket.
+      if (node.axis == leaf_axis_) {
+        out = search_bucket_(center, radius_sqr, node.first, node.second, out);
+        continue;
+      }
+
+      // Visit the far subtree only if it intersects the search sphere.
+      TIT_ASSERT(node.axis < Dim_, "Axis is out of range!");
+      const auto delta = center[node.axis] - node.split;
+      const auto [near_child, far_child] =
+          delta < Num_{} ? std::pair{node.first, node.second} :
+                           std::pair{node.second, node.first};
+      if (pow2(delta) <= radius_sqr) stack.push_back(far_child);
+      stack.push_back(near_child);
+    }
+    return out;
+  }
+
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+private:
+
+  using Num_ = vec_num_t<Vec>;
+  static constexpr auto Dim_ = vec_dim_v<Vec>;
+  static constexpr auto npos_ = std::numeric_limits<std::uint32_t>::max();
+  static constexpr auto leaf_axis_ = npos_;
+  static constexpr std::size_t max_depth_ = 64;
+
+  template<class OutIter>
+  auto search_bucket_(const Vec& center,
+                      Num_ radius_sqr,
+                      std::size_t first,
+                      std::size_t last,
+                      OutIter out) const -> OutIter {
+    TIT_ASSERT(last - first <= max_bucket_size, "Bucket is too large!");
+
+    // Compute the squared distances, axis by axis. Loops over the contiguous
+    // coordinates of the bucket are easily vectorized.
+    const auto size = last - first;
+    std::array<Num_, max_bucket_size> dists_sqr{};
+    for (std::size_t d = 0; d < Dim_; ++d) {
+      const auto* const coords = coords_[d].data() + first;
+      for (std::size_t i = 0; i < size; ++i) {
+        dists_sqr[i] += pow2(coords[i] - center[d]);
+      }
+    }
+
+    // Report the points within the search sphere.
+    for (std::size_t i = 0; i < size; ++i) {
+      if (dists_sqr[i] <= radius_sqr) *out++ = perm_[first + i];
+    }
+    return out;
+  }
+
+  struct Node_ final {
+    Num_ split = {};
+    std::uint32_t axis = leaf_axis_;
+    std::uint32_t first = 0;  // Left child or first bucket point.
+    std::uint32_t second = 0; // Right child or past-the-last bucket point.
+  };
+
+  Points points_;
+  std::vector<Node_> nodes_;
+  std::vector<std::size_t> perm_;
+  std::array<std::vector<Num_>, Dim_> coords_;
+
+}; // class BucketKDTreeIndex
+
+// Wrap a viewable range into a view on construction.
+template<std::ranges::viewable_range Points, class... Args>
+BucketKDTreeIndex(Points&&, Args...)
+    -> BucketKDTreeIndex<std::views::all_t<Points>>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Bucketed K-dimensional tree based spatial search indexing function.
+class BucketKDTreeSearch final {
+public:
+
+  /// Construct a bucketed K-dimensional tree search indexing function.
+  ///
+  /// @param bucket_size Number of points in a leaf bucket, up to 32.
+  constexpr explicit BucketKDTreeSearch(std::size_t bucket_size = 16)
+      : bucket_size_{bucket_size} {
+    TIT_ASSERT(bucket_size_ > 1 && bucket_size_ <= max_kd_tree_bucket_size,
+               "Bucket size is out of range!");
+  }
+
+  /// Index the points for search using a bucketed K-dimensional tree.
+  template<std::ranges::viewable_range Points>
+    requires deduce_constructible_from<BucketKDTreeIndex,
+                                       Points&&,
+                                       std::size_t>
+  [[nodiscard]] auto operator()(Points&& points) const {
+    TIT_PROFILE_SECTION("BucketKDTreeSearch::operator()");
+    return BucketKDTreeIndex{std::forward<Points>(points), bucket_size_};
+  }
+
+private:
+
+  std::size_t bucket_size_;
+
+}; // class BucketKDTreeSearch
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::geom
@@ -9,7 +9,6 @@
 #include <concepts>
 #include <cstddef>
 #include <iterator>
-#include <numeric>
 #include <ranges>
 #include <utility>
 #include <vector>
@@ -22,7 +21,6 @@
 #include "tit/geom/grid.hpp"
 #include "tit/geom/point_range.hpp"
 #include "tit/par/algorithms.hpp"
-#include "tit/par/atomic.hpp"
 
 namespace tit::geom {
 
@@ -55,33 +53,16 @@ public:
     const auto box = compute_bbox(points_).grow(size_hint / 2);
     grid_ = Grid{box}.set_cell_extents(size_hint);
 
-    // Count the points in each cell. Counts are shifted by two so that the
-    // fill positions turn into the final cell offsets in-place.
-    cell_point_offsets_.resize(grid_.flat_num_cells() + 2);
-    par::for_each(point_indices, [this](std::size_t point_index) {
-      const auto flat_cell = grid_.flat_cell_index(points_[point_index]);
-      TIT_ASSERT(flat_cell < grid_.flat_num_cells(),
-                 "Cell index is out of range!");
-      par::fetch_and_add(cell_point_offsets_[flat_cell + 2], 1);
-    });
-
-    // Convert the cell counts to offsets and allocate the point indices.
-    std::partial_sum(cell_point_offsets_.begin() + 2,
-                     cell_point_offsets_.end(),
-                     cell_point_offsets_.begin() + 2);
-    cell_points_.resize(cell_point_offsets_.back());
-
-    // Fill each cell range in parallel. Incrementing the shifted offsets
-    // leaves the final CSR offsets in the first `num_cells + 1` entries.
-    par::for_each(point_indices, [this](std::size_t point_index) {
-      const auto flat_cell = grid_.flat_cell_index(points_[point_index]);
-      TIT_ASSERT(flat_cell < grid_.flat_num_cells(),
-                 "Cell index is out of range!");
-      const auto position =
-          par::fetch_and_add(cell_point_offsets_[flat_cell + 1], 1);
-      cell_points_[position] = point_index;
-    });
-    cell_point_offsets_.pop_back();
+    // Group the point indices by the cells.
+    cell_point_offsets_.resize(grid_.flat_num_cells() + 1);
+    cell_points_.resize(std::ranges::size(points_));
+    par::unstable_counting_sort(point_indices,
+                                cell_point_offsets_,
+                                cell_points_.begin(),
+                                [this](std::size_t point_index) {
+                                  return grid_.flat_cell_index(
+                                      points_[point_index]);
+                                });
   }
 
   /// Find the points within the given sphere.
@@ -0,0 +1,214 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "tit/core/assert.hpp"
+#include "tit/core/profiler.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/point_range.hpp"
+#include "tit/par/algorithms.hpp"
+
+namespace tit::geom {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace impl {
+
+// Number of bits per axis in the 64-bit curve key.
+template<std::size_t Dim>
+inline constexpr std::size_t curve_key_bits_v = Dim == 1 ? 32 : 64 / Dim;
+
+// Quantized point coordinates.
+template<std::size_t Dim>
+using CurveCoords = std::array<std::uint64_t, Dim>;
+
+// Spread the lower bits of the number, such that there are `Dim - 1` zero
+// bits between the consecutive bits.
+template<std::size_t Dim>
+constexpr auto spread_bits(std::uint64_t x) noexcept -> std::uint64_t {
+  if constexpr (Dim == 1) {
+    return x;
+  } else if constexpr (Dim == 2) {
+    x &= 0x0000'0000'FFFF'FFFF;
+    x = (x | (x << 16)) & 0x0000'FFFF'0000'FFFF;
+    x = (x | (x << 8)) & 0x00FF'00FF'00FF'00FF;
+    x = (x | (x << 4)) & 0x0F0F'0F0F'0F0F'0F0F;
+    x = (x | (x << 2)) & 0x3333'3333'3333'3333;
+    x = (x | (x << 1)) & 0x5555'5555'5555'5555;
+    return x;
+  } else if constexpr (Dim == 3) {
+    x &= 0x0000'0000'001F'FFFF;
+    x = (x | (x << 32)) & 0x001F'0000'0000'FFFF;
+    x = (x | (x << 16)) & 0x001F'0000'FF00'00FF;
+    x = (x | (x << 8)) & 0x100F'00F0'0F00'F00F;
+    x = (x | (x << 4)) & 0x10C3'0C30'C30C'30C3;
+    x = (x | (x << 2)) & 0x1249'2492'4924'9249;
+    return x;
+  } else {
+    static_assert(false);
+  }
+}
+
+// Interleave the bits of the coordinates. First coordinate takes the most
+// significant bit within each group.
+template<std::size_t Dim>
+constexpr auto interleave_bits(const CurveCoords<Dim>& coords) noexcept
+    -> std::uint64_t {
+  std::uint64_t key = 0;
+  for (std::size_t i = 0; i < Dim; ++i) {
+    key |= spread_bits<Dim>(coords[i]) << (Dim - i - 1);
+  }
+  return key;
+}
+
+// Compute the Morton curve key of the quantized point. Axis order matches the
+// one of the `MortonCurveSort`, so Y axis takes the most significant bit.
+template<std::size_t Dim>
+constexpr auto morton_key(const CurveCoords<Dim>& coords) noexcept
+    -> std::uint64_t {
+  CurveCoords<Dim> ordered_coords{};
+  for (std::size_t i = 0; i < Dim; ++i) {
+    ordered_coords[i] = coords[(i + 1) % Dim];
+  }
+  return interleave_bits(ordered_coords);
+}
+
+// Compute the Hilbert curve key of the quantized point.
+//
+// Coordinates are converted into the "transposed" Hilbert index using the
+// Skilling's algorithm, which is then interleaved into the key.
+template<std::size_t Dim>
+constexpr auto hilbert_key(CurveCoords<Dim> coords) noexcept -> std::uint64_t {
+  constexpr auto high_bit = std::uint64_t{1} << (curve_key_bits_v<Dim> - 1);
+
+  // Undo the excess work.
+  for (auto bit = high_bit; bit > 1; bit >>= 1) {
+    const auto mask = bit - 1;
+    for (std::size_t i = 0; i < Dim; ++i) {
+      if ((coords[i] & bit) != 0) {
+        coords[0] ^= mask;
+      } else {
+        const auto swap_mask = (coords[0] ^ coords[i]) & mask;
+        coords[0] ^= swap_mask, coords[i] ^= swap_mask;
+      }
+    }
+  }
+
+  // Apply the Gray encoding.
+  for (std::size_t i = 1; i < Dim; ++i) coords[i] ^= coords[i - 1];
+  std::uint64_t flip_mask = 0;
+  for (auto bit = high_bit; bit > 1; bit >>= 1) {
+    if ((coords[Dim - 1] & bit) != 0) flip_mask ^= bit - 1;
+  }
+  for (auto& coord : coords) coord ^= flip_mask;
+
+  return interleave_bits(coords);
+}
+
+// Order the points by the space filling curve keys.
+template<point_range Points, class KeyFunc>
+void curve_key_sort(Points&& points,
+                    std::span<std::size_t> perm,
+                    const KeyFunc& key_func) {
+  using Num = point_range_num_t<Points>;
+  static constexpr auto Dim = point_range_dim_v<Points>;
+  TIT_ASSERT(std::ranges::size(points) == perm.size(),
+             "Size of permutation must be equal to the number of points!");
+
+  // Compute the quantization scale of the bounding box. Flat axes are
+  // collapsed into a single coordinate.
+  static constexpr auto max_coord =
+      (std::uint64_t{1} << curve_key_bits_v<Dim>) - 1;
+  const auto box = compute_bbox(points);
+  const auto extents = box.extents();
+  point_range_vec_t<Points> scale{};
+  for (std::size_t i = 0; i < Dim; ++i) {
+    if (extents[i] > Num{0}) {
+      scale[i] = static_cast<Num>(max_coord + 1) / extents[i];
+    }
+  }
+
+  // Compute the keys.
+  std::vector<std::uint64_t> keys(perm.size());
+  par::for_each(std::views::zip(points, keys),
+                [&box, &scale, &key_func](auto point_and_key) {
+                  auto&& [point, key] = point_and_key;
+                  const auto scaled = (point - box.low()) * scale;
+                  CurveCoords<Dim> coords{};
+                  for (std::size_t i = 0; i < Dim; ++i) {
+                    coords[i] =
+                        std::min(static_cast<std::uint64_t>(scaled[i]),
+                                 max_coord);
+                  }
+                  key = key_func(coords);
+                });
+
+  // Sort the points by the keys.
+  std::ranges::iota(perm, std::size_t{0});
+  par::radix_sort_by_key(keys, perm);
+}
+
+} // namespace impl
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Morton space filling curve key-based spatial sort function.
+///
+/// Unlike the `MortonCurveSort`, points are quantized into the 64-bit Morton
+/// keys, which are then sorted using the parallel radix sort. Points that
+/// share the same key preserve their relative order.
+class MortonKeySort final {
+public:
+
+  /// Order the points along the Morton space filling curve.
+  template<point_range Points>
+  void operator()(Points&& points, std::span<std::size_t> perm) const {
+    TIT_PROFILE_SECTION("MortonKeySort::operator()");
+    impl::curve_key_sort(points, perm, [](const auto& coords) {
+      return impl::morton_key(coords);
+    });
+  }
+
+}; // class MortonKeySort
+
+/// Morton space filling curve key-based spatial sort.
+inline constexpr MortonKeySort morton_key_sort{};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Hilbert space filling curve key-based spatial sort function.
+///
+/// Unlike the `HilbertCurveSort`, points are quantized into the 64-bit Hilbert
+/// keys, which are then sorted using the parallel radix sort. Points that
+/// share the same key preserve their relative order.
+class HilbertKeySort final {
+public:
+
+  /// Order the points along the Hilbert space filling curve.
+  template<point_range Points>
+  void operator()(Points&& points, std::span<std::size_t> perm) const {
+    TIT_PROFILE_SECTION("HilbertKeySort::operator()");
+    impl::curve_key_sort(points, perm, [](const auto& coords) {
+      return impl::hilbert_key(coords);
+    });
+  }
+
+}; // class HilbertKeySort
+
+/// Hilbert space filling curve key-based spatial sort.
+inline constexpr HilbertKeySort hilbert_key_sort{};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::geom
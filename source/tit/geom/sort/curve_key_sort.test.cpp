@@ -0,0 +1,89 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <array>
+#include <cstddef>
+#include <ranges>
+
+#include "tit/core/vec.hpp"
+#include "tit/geom/sort/curve_key_sort.hpp"
+#include "tit/geom/sort/morton_curve_sort.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+using Vec2D = Vec<double, 2>;
+using Vec3D = Vec<double, 3>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("geom::MortonKeySort") {
+  // Create points on a 8x8 lattice.
+  std::array<Vec2D, 64> points{};
+  for (std::size_t i = 0; i < 64; ++i) points[i] = {i % 8, i / 8};
+
+  // Sort points using the Morton curve keys.
+  std::array<std::size_t, 64> perm{};
+  geom::morton_key_sort(points, perm);
+
+  // Ensure the resulting permutation matches the recursive Morton sort.
+  std::array<std::size_t, 64> expected_perm{};
+  geom::morton_curve_sort(points, expected_perm);
+  CHECK_RANGE_EQ(perm, expected_perm);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("geom::HilbertKeySort") {
+  SUBCASE("2D") {
+    // Create points on a 8x8 lattice.
+    std::array<Vec2D, 64> points{};
+    for (std::size_t i = 0; i < 64; ++i) points[i] = {i % 8, i / 8};
+
+    // Sort points using the Hilbert curve keys.
+    std::array<std::size_t, 64> perm{};
+    geom::hilbert_key_sort(points, perm);
+
+    // Ensure the resulting permutation is correct. Position of each lattice
+    // point along the curve is (X is horizontal, Y is vertical, downwards):
+    //
+    //    0  3  4  5 58 59 60 63
+    //    1  2  7  6 57 56 61 62
+    //   14 13  8  9 54 55 50 49
+    //   15 12 11 10 53 52 51 48
+    //   16 17 30 31 32 33 46 47
+    //   19 18 29 28 35 34 45 44
+    //   20 23 24 27 36 39 40 43
+    //   21 22 25 26 37 38 41 42
+    //
+    CHECK_RANGE_EQ(perm, {0,  8,  9,  1,  2,  3,  11, 10, 18, 19, 27, 26, 25,
+                          17, 16, 24, 32, 33, 41, 40, 48, 56, 57, 49, 50, 58,
+                          59, 51, 43, 42, 34, 35, 36, 37, 45, 44, 52, 60, 61,
+                          53, 54, 62, 63, 55, 47, 46, 38, 39, 31, 23, 22, 30,
+                          29, 28, 20, 21, 13, 12, 4,  5,  6,  14, 15, 7});
+  }
+  SUBCASE("3D") {
+    // Create points on a 4x4x4 lattice.
+    std::array<Vec3D, 64> points{};
+    for (std::size_t i = 0; i < 64; ++i) {
+      points[i] = {i % 4, (i / 4) % 4, i / 16};
+    }
+
+    // Sort points using the Hilbert curve keys.
+    std::array<std::size_t, 64> perm{};
+    geom::hilbert_key_sort(points, perm);
+
+    // Ensure that the consecutive points are the lattice neighbors.
+    for (const auto& [a, b] : std::views::pairwise(perm)) {
+      CHECK(norm(points[a] - points[b]) == 1.0);
+    }
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
@@ -6,19 +6,30 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <inplace_vector>
 #include <iterator>
+#include <numeric>
 #include <ranges>
+#include <span>
+#include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/parallel_for.h>
 #include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/parallel_scan.h>
+#include <oneapi/tbb/parallel_sort.h>
 
+#include "tit/core/assert.hpp"
+#include "tit/core/math.hpp"
 #include "tit/par/atomic.hpp"
 #include "tit/par/control.hpp"
 
@@ -78,6 +89,47 @@ struct ForEach final {
 /// @copydoc ForEach
 inline constexpr ForEach for_each{};
 
+namespace impl {
+
+// Minimal number of elements per NUMA node to distribute the range.
+inline constexpr std::size_t min_numa_chunk_size = 4096;
+
+} // namespace impl
+
+/// Iterate through the range in parallel, distributing it across the NUMA
+/// nodes.
+///
+/// If the worker threads are pinned to the NUMA nodes, large ranges are split
+/// into the contiguous chunks, one per node, each processed by the threads of
+/// the corresponding node. This is intended for the loops that first touch
+/// the memory, so that the pages are placed on the nodes evenly. Loops nested
+/// into the node arena are not distributed again.
+struct NumaForEach final {
+  template<range Range,
+           std::regular_invocable<std::ranges::range_reference_t<Range&&>> Func>
+  static void operator()(Range&& range, Func func) {
+    const auto size = std::ranges::size(range);
+    const auto num_nodes = num_numa_nodes();
+    if (num_nodes <= 1 || current_numa_node().has_value() ||
+        size < num_nodes * impl::min_numa_chunk_size) {
+      for_each(std::forward<Range>(range), std::move(func));
+      return;
+    }
+    const auto first = std::ranges::begin(range);
+    for_each_numa_node([first, size, num_nodes, &func](std::size_t node) {
+      using Diff = std::iter_difference_t<decltype(first)>;
+      const auto chunk_first =
+          first + static_cast<Diff>(size * node / num_nodes);
+      const auto chunk_last =
+          first + static_cast<Diff>(size * (node + 1) / num_nodes);
+      for_each(std::ranges::subrange{chunk_first, chunk_last}, std::cref(func));
+    });
+  }
+};
+
+/// @copydoc NumaForEach
+inline constexpr NumaForEach numa_for_each{};
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 /// Iterate through the block of ranges in parallel.
@@ -131,6 +183,169 @@ struct Fold final {
 /// @copydoc Fold
 inline constexpr Fold fold{};
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace impl {
+
+// Number of elements in a single block of the deterministic fold.
+inline constexpr std::size_t deterministic_fold_block_size = 1024;
+
+} // namespace impl
+
+/// Deterministic parallel fold.
+///
+/// Range is split into the blocks of the fixed size, which are folded in
+/// parallel, and then the block results are combined pairwise in a fixed
+/// tree order. Hence, the result does not depend on the number of threads or
+/// on the task scheduling, even if the operations are not associative, like
+/// the floating-point summation.
+struct DeterministicFold final {
+  template<range Range,
+           class Result = std::ranges::range_value_t<Range>,
+           std::regular_invocable<Result, std::ranges::range_reference_t<Range>>
+               Func = std::plus<>,
+           std::regular_invocable<Result, Result> ResultFunc = Func>
+    requires (
+        std::assignable_from<
+            Result&,
+            std::invoke_result_t<Func&,
+                                 Result,
+                                 std::ranges::range_reference_t<Range>>> &&
+        std::assignable_from<Result&,
+                             std::invoke_result_t<ResultFunc&, Result, Result>>)
+  static auto operator()(Range&& range,
+                         Result init = {},
+                         Func func = {},
+                         ResultFunc result_func = {}) -> Result {
+    // Fold the blocks.
+    auto blocks =
+        std::views::chunk(range, impl::deterministic_fold_block_size);
+    std::vector<Result> partials(std::ranges::size(blocks), init);
+    if (partials.empty()) return init;
+    for_each(std::views::zip(blocks, partials),
+             [&func](auto block_and_partial) {
+               auto&& [block, partial] = block_and_partial;
+               partial =
+                   std::ranges::fold_left(block, std::move(partial), func);
+             });
+
+    // Combine the block results pairwise. At each level, the result of each
+    // block is combined with the result of the block `stride` blocks ahead.
+    for (std::size_t stride = 1; stride < partials.size(); stride *= 2) {
+      const auto step = 2 * stride;
+      const auto num_pairs = divide_up(partials.size() - stride, step);
+      for_each(std::views::iota(std::size_t{0}, num_pairs),
+               [&partials, &result_func, stride, step](std::size_t index) {
+                 auto& left = partials[index * step];
+                 const auto& right = partials[index * step + stride];
+                 left = result_func(std::move(left), right);
+               });
+    }
+    return std::move(partials.front());
+  }
+};
+
+/// @copydoc DeterministicFold
+inline constexpr DeterministicFold deterministic_fold{};
+
+/// Summation algorithm.
+enum class SumMode : std::uint8_t {
+  pairwise, ///< Plain summation within the blocks, pairwise across them.
+  kahan,    ///< Compensated summation within and across the blocks.
+};
+
+/// Deterministic parallel sum.
+///
+/// @copydetails DeterministicFold
+struct DeterministicSum final {
+  template<range Range,
+           class Proj = std::identity,
+           class Result = std::remove_cvref_t<
+               std::invoke_result_t<Proj&,
+                                    std::ranges::range_reference_t<Range>>>>
+  static auto operator()(Range&& range,
+                         Result init = {},
+                         SumMode mode = SumMode::pairwise,
+                         Proj proj = {}) -> Result {
+    switch (mode) {
+      case SumMode::pairwise: {
+        const auto sum = deterministic_fold(
+            range,
+            Result{},
+            [&proj](Result partial, auto&& val) {
+              return partial + std::invoke(proj, val);
+            },
+            std::plus{});
+        return init + sum;
+      }
+      case SumMode::kahan: {
+        const auto sum = deterministic_fold(
+            range,
+            KahanSum<Result>{},
+            [&proj](KahanSum<Result> partial, auto&& val) {
+              return partial + static_cast<Result>(std::invoke(proj, val));
+            },
+            std::plus{});
+        return (KahanSum{std::move(init)} + sum).value();
+      }
+      default: std::unreachable();
+    }
+  }
+};
+
+/// @copydoc DeterministicSum
+inline constexpr DeterministicSum deterministic_sum{};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Scan operations.
+//
+
+/// Parallel exclusive scan.
+///
+/// The i-th output element is the initial value combined with the first i
+/// elements of the range. Default-constructed result must be the identity of
+/// the operation. Output range may be the input range itself.
+///
+/// @returns Initial value combined with all the elements of the range.
+struct ExclusiveScan final {
+  template<range Range,
+           std::random_access_iterator OutIter,
+           class Result = std::ranges::range_value_t<Range>,
+           std::regular_invocable<Result, Result> Op = std::plus<>>
+    requires std::indirectly_writable<OutIter, Result> &&
+             std::assignable_from<Result&,
+                                  std::invoke_result_t<Op&, Result, Result>>
+  static auto operator()(Range&& range,
+                         OutIter out,
+                         Result init = {},
+                         Op op = {}) -> Result {
+    const auto first = std::ranges::begin(range);
+    const auto sum = tbb::parallel_scan(
+        tbb::blocked_range<std::size_t>{0, std::ranges::size(range)},
+        Result{},
+        [first, out, &init, &op](const tbb::blocked_range<std::size_t>& block,
+                                 Result partial,
+                                 bool is_final_scan) {
+          for (auto i = block.begin(); i != block.end(); ++i) {
+            const auto offset = static_cast<std::ptrdiff_t>(i);
+            // Read the input element first, since the output may alias it.
+            Result val = *std::next(first, offset);
+            if (is_final_scan) *std::next(out, offset) = op(init, partial);
+            partial = op(std::move(partial), std::move(val));
+          }
+          return partial;
+        },
+        [&op](const Result& left, const Result& right) {
+          return op(left, right);
+        });
+    return op(std::move(init), sum);
+  }
+};
+
+/// @copydoc ExclusiveScan
+inline constexpr ExclusiveScan exclusive_scan{};
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //
 // Copy operations.
@@ -176,6 +391,450 @@ struct UnstableCopyIf final {
 /// @copydoc CopyIf
 inline constexpr UnstableCopyIf unstable_copy_if{};
 
+/// Parallel stable copy-if.
+/// Relative order of the elements in the output range is preserved.
+struct StableCopyIf final {
+  template<range Range,
+           std::random_access_iterator OutIter,
+           class Proj = std::identity,
+           std::indirect_unary_predicate<
+               std::projected<std::ranges::iterator_t<Range>, Proj>> Pred>
+    requires std::indirectly_copyable<std::ranges::iterator_t<Range>, OutIter>
+  static auto operator()(Range&& range, OutIter out, Pred pred, Proj proj = {})
+      -> OutIter {
+    // Count the elements that satisfy the predicate within each block, and
+    // compute the output offsets of the blocks.
+    static constexpr std::size_t BlockSize = 4096;
+    const auto blocks = std::views::chunk(range, BlockSize);
+    std::vector<std::size_t> block_offsets(std::ranges::size(blocks));
+    for_each(std::views::zip(blocks, block_offsets),
+             [&pred, &proj](auto block_and_count) {
+               auto&& [block, count] = block_and_count;
+               count = static_cast<std::size_t>(
+                   std::ranges::count_if(block,
+                                         std::ref(pred),
+                                         std::ref(proj)));
+             });
+    const auto count = exclusive_scan(block_offsets, block_offsets.begin());
+
+    // Copy the elements of each block into the output range.
+    for_each(std::views::zip(blocks, block_offsets),
+             [out, &pred, &proj](auto block_and_offset) {
+               auto&& [block, offset] = block_and_offset;
+               std::ranges::copy_if(
+                   block,
+                   std::next(out, static_cast<std::ptrdiff_t>(offset)),
+                   std::ref(pred),
+                   std::ref(proj));
+             });
+    return std::next(out, static_cast<std::ptrdiff_t>(count));
+  }
+};
+
+/// @copydoc StableCopyIf
+inline constexpr StableCopyIf stable_copy_if{};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Partition operations.
+//
+
+/// Parallel stable partition.
+/// Relative order of the elements in both parts is preserved.
+struct Partition final {
+  template<range Range,
+           class Proj = std::identity,
+           std::indirect_unary_predicate<
+               std::projected<std::ranges::iterator_t<Range>, Proj>> Pred>
+    requires std::permutable<std::ranges::iterator_t<Range>>
+  static auto operator()(Range&& range, Pred pred, Proj proj = {})
+      -> std::ranges::borrowed_subrange_t<Range> {
+    // Small ranges are partitioned serially.
+    static constexpr std::size_t BlockSize = 4096;
+    const auto size = std::ranges::size(range);
+    if (size <= BlockSize) {
+      const auto right = std::ranges::stable_partition(range,
+                                                       std::ref(pred),
+                                                       std::ref(proj));
+      return {std::ranges::begin(right), std::ranges::end(right)};
+    }
+
+    // Move the elements into the temporary buffer.
+    using Val = std::ranges::range_value_t<Range>;
+    const auto first = std::ranges::begin(range);
+    const auto last = std::ranges::end(range);
+    std::vector<Val> buffer(std::make_move_iterator(first),
+                            std::make_move_iterator(last));
+
+    // Count the elements that satisfy the predicate within each block, and
+    // compute the block offsets. Blocks are of the fixed size, so the result
+    // does not depend on the number of threads or on the task scheduling.
+    const auto blocks = std::views::chunk(buffer, BlockSize);
+    std::vector<std::size_t> block_offsets(std::ranges::size(blocks) + 1);
+    for_each(std::views::zip(blocks, block_offsets | std::views::drop(1)),
+             [&pred, &proj](auto block_and_count) {
+               auto&& [block, count] = block_and_count;
+               count = static_cast<std::size_t>(
+                   std::ranges::count_if(block,
+                                         std::ref(pred),
+                                         std::ref(proj)));
+             });
+    std::partial_sum(block_offsets.begin(),
+                     block_offsets.end(),
+                     block_offsets.begin());
+
+    // Move the elements of each block back into the both parts.
+    const auto num_left = block_offsets.back();
+    for_each(std::views::enumerate(blocks),
+             [first, num_left, &block_offsets, &pred, &proj](
+                 auto index_and_block) {
+               auto&& [block_index, block] = index_and_block;
+               const auto index = static_cast<std::size_t>(block_index);
+               const auto left_offset = block_offsets[index];
+               const auto right_offset =
+                   num_left + (index * BlockSize) - left_offset;
+               auto left_iter =
+                   std::next(first, static_cast<std::ptrdiff_t>(left_offset));
+               auto right_iter =
+                   std::next(first, static_cast<std::ptrdiff_t>(right_offset));
+               for (auto& val : block) {
+                 if (std::invoke(pred, std::invoke(proj, val))) {
+                   *left_iter++ = std::move(val);
+                 } else {
+                   *right_iter++ = std::move(val);
+                 }
+               }
+             });
+    return {std::next(first, static_cast<std::ptrdiff_t>(num_left)), last};
+  }
+};
+
+/// @copydoc Partition
+inline constexpr Partition partition{};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Histogram operations.
+//
+
+namespace impl {
+
+// Maximal number of bins that are counted per block in the histograms.
+inline constexpr std::size_t max_block_histogram_bins = 256;
+
+} // namespace impl
+
+/// Parallel histogram.
+/// Number of the elements that fall into each bin is stored into the counts.
+struct Histogram final {
+  template<range Range,
+           range Counts,
+           std::regular_invocable<std::ranges::range_reference_t<Range>>
+               BinFunc>
+    requires std::integral<std::ranges::range_value_t<Counts>>
+  static void operator()(Range&& range, Counts&& counts, BinFunc bin_func) {
+    using Count = std::ranges::range_value_t<Counts>;
+    const auto num_bins = std::ranges::size(counts);
+    const auto size = std::ranges::size(range);
+    const auto first = std::ranges::begin(range);
+
+    // With many bins (like the grid cells), the increments rarely collide,
+    // so the elements are counted atomically into the shared bins. A copy of
+    // the histogram per block would cost too much memory and time here.
+    if (num_bins > impl::max_block_histogram_bins) {
+      for_each(counts, [](auto& count) { count = 0; });
+      const auto first_count = std::ranges::begin(counts);
+      for_each(range, [first_count, num_bins, &bin_func](auto&& val) {
+        const auto bin = static_cast<std::size_t>(std::invoke(bin_func, val));
+        TIT_ASSERT(bin < num_bins, "Bin index is out of range!");
+        fetch_and_add(*std::next(first_count, static_cast<std::ptrdiff_t>(bin)),
+                      1);
+      });
+      return;
+    }
+
+    // With few bins (like the part indices or the radix digits), atomic
+    // increments contend heavily. Instead, each block counts its elements
+    // into its own histogram, and the histograms are reduced per bin.
+    static constexpr std::size_t BlockSize = 16384;
+    const auto num_blocks = divide_up(size, BlockSize);
+    std::vector<std::size_t> block_counts(num_blocks * num_bins, 0);
+    for_each(std::views::iota(std::size_t{0}, num_blocks),
+             [&block_counts, &bin_func, first, size, num_bins](
+                 std::size_t block) {
+               const auto local_counts = std::span{block_counts}.subspan(
+                   block * num_bins,
+                   num_bins);
+               for (auto i = block * BlockSize;
+                    i < std::min((block + 1) * BlockSize, size);
+                    ++i) {
+                 const auto bin = static_cast<std::size_t>(std::invoke(
+                     bin_func,
+                     *std::next(first, static_cast<std::ptrdiff_t>(i))));
+                 TIT_ASSERT(bin < num_bins, "Bin index is out of range!");
+                 local_counts[bin] += 1;
+               }
+             });
+
+    // Reduce the block histograms into the counts.
+    for_each(std::views::zip(std::views::iota(std::size_t{0}, num_bins),
+                             counts),
+             [&block_counts, num_blocks, num_bins](auto bin_and_count) {
+               auto&& [bin, count] = bin_and_count;
+               std::size_t total = 0;
+               for (std::size_t block = 0; block < num_blocks; ++block) {
+                 total += block_counts[block * num_bins + bin];
+               }
+               count = static_cast<Count>(total);
+             });
+  }
+};
+
+/// @copydoc Histogram
+inline constexpr Histogram histogram{};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Sort operations.
+//
+
+/// Parallel unstable sort.
+struct Sort final {
+  template<range Range,
+           class Compare = std::ranges::less,
+           class Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<Range>, Compare, Proj>
+  static void operator()(Range&& range, Compare compare = {}, Proj proj = {}) {
+    tbb::parallel_sort(
+        std::ranges::begin(range),
+        std::ranges::end(range),
+        [&compare, &proj](const auto& a, const auto& b) {
+          return std::invoke(compare,
+                             std::invoke(proj, a),
+                             std::invoke(proj, b));
+        });
+  }
+};
+
+/// @copydoc Sort
+inline constexpr Sort sort{};
+
+/// Parallel stable LSD radix sort by the unsigned integer keys.
+/// Values are permuted along with the keys.
+struct RadixSortByKey final {
+  template<range Keys, range Vals>
+    requires std::unsigned_integral<std::ranges::range_value_t<Keys>> &&
+             std::permutable<std::ranges::iterator_t<Keys>> &&
+             std::permutable<std::ranges::iterator_t<Vals>>
+  static void operator()(Keys&& keys, Vals&& vals) {
+    using Key = std::ranges::range_value_t<Keys>;
+    using Val = std::ranges::range_value_t<Vals>;
+    TIT_ASSERT(std::ranges::size(keys) == std::ranges::size(vals),
+               "Keys and values must be of the same size!");
+
+    // Small ranges are sorted serially.
+    static constexpr std::size_t BlockSize = 16384;
+    const auto size = std::ranges::size(keys);
+    if (size <= BlockSize) {
+      std::ranges::stable_sort(std::views::zip(keys, vals),
+                               std::less{},
+                               [](const auto& key_and_val) {
+                                 return std::get<0>(key_and_val);
+                               });
+      return;
+    }
+
+    // Compute the number of passes from the largest key.
+    static constexpr std::size_t RadixBits = 8;
+    static constexpr std::size_t NumBuckets = std::size_t{1} << RadixBits;
+    const auto max_key = fold(keys, Key{0}, [](Key a, Key b) {
+      return std::max(a, b);
+    });
+    const auto num_passes =
+        divide_up(static_cast<std::size_t>(std::bit_width(max_key)), RadixBits);
+    if (num_passes == 0) return;
+
+    // Move the keys and values into the temporary buffers.
+    std::vector<Key> src_keys(std::ranges::begin(keys), std::ranges::end(keys));
+    std::vector<Val> src_vals(std::make_move_iterator(std::ranges::begin(vals)),
+                              std::make_move_iterator(std::ranges::end(vals)));
+    std::vector<Key> dst_keys(size);
+    std::vector<Val> dst_vals(size);
+
+    // Sort the keys digit by digit, starting from the least significant one.
+    // Each pass is a stable counting sort: blocks compute the histograms of
+    // the digits in parallel, the histograms are scanned into the output
+    // offsets, and then blocks scatter their elements in parallel.
+    const auto num_blocks = divide_up(size, BlockSize);
+    const auto block_indices = std::views::iota(std::size_t{0}, num_blocks);
+    std::vector<std::array<std::size_t, NumBuckets>> block_offsets(num_blocks);
+    for (std::size_t pass = 0; pass < num_passes; ++pass) {
+      const auto digit = [shift = pass * RadixBits](Key key) {
+        return static_cast<std::size_t>((key >> shift) & (NumBuckets - 1));
+      };
+      const auto block_range = [size](std::size_t block) {
+        return std::views::iota(block * BlockSize,
+                                std::min((block + 1) * BlockSize, size));
+      };
+
+      // Compute the digit histograms of the blocks.
+      for_each(block_indices,
+               [&block_offsets, &src_keys, &digit, &block_range](
+                   std::size_t block) {
+                 auto& counts = block_offsets[block];
+                 counts.fill(0);
+                 for (const auto i : block_range(block)) {
+                   counts[digit(src_keys[i])] += 1;
+                 }
+               });
+
+      // Scan the histograms into the offsets.
+      std::size_t offset = 0;
+      for (std::size_t bucket = 0; bucket < NumBuckets; ++bucket) {
+        for (auto& offsets : block_offsets) {
+          offset += std::exchange(offsets[bucket], offset);
+        }
+      }
+
+      // Scatter the elements.
+      for_each(block_indices,
+               [&block_offsets,
+                &src_keys,
+                &src_vals,
+                &dst_keys,
+                &dst_vals,
+                &digit,
+                &block_range](std::size_t block) {
+                 auto& offsets = block_offsets[block];
+                 for (const auto i : block_range(block)) {
+                   const auto j = offsets[digit(src_keys[i])]++;
+                   dst_keys[j] = src_keys[i];
+                   dst_vals[j] = std::move(src_vals[i]);
+                 }
+               });
+      src_keys.swap(dst_keys);
+      src_vals.swap(dst_vals);
+    }
+
+    // Move the sorted keys and values back.
+    for_each(std::views::zip(src_keys, src_vals, keys, vals),
+             [](auto src_and_dst) {
+               auto&& [src_key, src_val, key, val] = src_and_dst;
+               key = src_key;
+               val = std::move(src_val);
+             });
+  }
+};
+
+/// @copydoc RadixSortByKey
+inline constexpr RadixSortByKey radix_sort_by_key{};
+
+/// Parallel stable sort by the keys.
+/// Values are permuted along with the keys.
+struct SortByKey final {
+  template<range Keys, range Vals, class Compare = std::ranges::less>
+    requires std::permutable<std::ranges::iterator_t<Keys>> &&
+             std::permutable<std::ranges::iterator_t<Vals>> &&
+             std::indirect_strict_weak_order<Compare,
+                                             std::ranges::iterator_t<Keys>>
+  static void operator()(Keys&& keys, Vals&& vals, Compare compare = {}) {
+    using Key = std::ranges::range_value_t<Keys>;
+    using Val = std::ranges::range_value_t<Vals>;
+    TIT_ASSERT(std::ranges::size(keys) == std::ranges::size(vals),
+               "Keys and values must be of the same size!");
+
+    // Unsigned integer keys in the ascending order are sorted with the radix
+    // sort.
+    if constexpr (std::unsigned_integral<Key> &&
+                  std::same_as<Compare, std::ranges::less>) {
+      radix_sort_by_key(keys, vals);
+    } else {
+      // Sort the permutation. Ties are broken by the original positions, so
+      // that the sort is stable.
+      const auto size = std::ranges::size(keys);
+      const auto keys_first = std::ranges::begin(keys);
+      const auto vals_first = std::ranges::begin(vals);
+      std::vector<std::size_t> perm(size);
+      std::ranges::iota(perm, std::size_t{0});
+      sort(perm, [keys_first, &compare](std::size_t a, std::size_t b) {
+        const auto& key_a = keys_first[static_cast<std::ptrdiff_t>(a)];
+        const auto& key_b = keys_first[static_cast<std::ptrdiff_t>(b)];
+        if (std::invoke(compare, key_a, key_b)) return true;
+        if (std::invoke(compare, key_b, key_a)) return false;
+        return a < b;
+      });
+
+      // Permute the keys and values.
+      std::vector<Key> sorted_keys(size);
+      std::vector<Val> sorted_vals(size);
+      for_each(std::views::zip(perm, sorted_keys, sorted_vals),
+               [keys_first, vals_first](auto index_and_dst) {
+                 auto&& [index, key, val] = index_and_dst;
+                 const auto offset = static_cast<std::ptrdiff_t>(index);
+                 key = std::move(keys_first[offset]);
+                 val = std::move(vals_first[offset]);
+               });
+      for_each(std::views::zip(sorted_keys, sorted_vals, keys, vals),
+               [](auto src_and_dst) {
+                 auto&& [src_key, src_val, key, val] = src_and_dst;
+                 key = std::move(src_key);
+                 val = std::move(src_val);
+               });
+    }
+  }
+};
+
+/// @copydoc SortByKey
+inline constexpr SortByKey sort_by_key{};
+
+/// Parallel unstable counting sort.
+///
+/// Elements of the range are grouped by their bin indices into the output
+/// range. Elements of the i-th bin are stored within the output positions
+/// `[bin_offsets[i], bin_offsets[i + 1])`, so the bin offsets range must
+/// have one element more than the number of bins. Relative order of the
+/// elements within the bins is not preserved.
+struct UnstableCountingSort final {
+  template<range Range,
+           range BinOffsets,
+           std::random_access_iterator OutIter,
+           std::regular_invocable<std::ranges::range_reference_t<Range>>
+               BinFunc>
+    requires std::integral<std::ranges::range_value_t<BinOffsets>> &&
+             std::indirectly_copyable<std::ranges::iterator_t<Range>, OutIter>
+  static auto operator()(Range&& range,
+                         BinOffsets&& bin_offsets,
+                         OutIter out,
+                         BinFunc bin_func) -> OutIter {
+    TIT_ASSERT(!std::ranges::empty(bin_offsets),
+               "Bin offsets must not be empty!");
+
+    // Count the elements in each bin and convert the counts to offsets. Counts
+    // are shifted by one, so that the fill positions turn into the final bin
+    // offsets in-place.
+    const auto offsets_first = std::ranges::begin(bin_offsets);
+    *offsets_first = 0;
+    const auto bin_counts = bin_offsets | std::views::drop(1);
+    histogram(range, bin_counts, std::ref(bin_func));
+    exclusive_scan(bin_counts, std::ranges::begin(bin_counts));
+
+    // Fill the bins in parallel.
+    for_each(range, [out, offsets_first, &bin_func](auto&& val) {
+      const auto bin = static_cast<std::size_t>(std::invoke(bin_func, val));
+      const auto position = fetch_and_add(
+          *std::next(offsets_first, static_cast<std::ptrdiff_t>(bin + 1)),
+          1);
+      *std::next(out, static_cast<std::ptrdiff_t>(position)) =
+          std::forward<decltype(val)>(val);
+    });
+    return std::next(out,
+                     static_cast<std::ptrdiff_t>(std::ranges::size(range)));
+  }
+};
+
+/// @copydoc UnstableCountingSort
+inline constexpr UnstableCountingSort unstable_counting_sort{};
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace tit::par
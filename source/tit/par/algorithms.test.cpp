@@ -4,11 +4,16 @@
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <ranges>
+#include <span>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "tit/core/math.hpp"
 #include "tit/par/algorithms.hpp"
 #include "tit/par/control.hpp"
 #include "tit/testing/test.hpp"
@@ -49,6 +54,36 @@ TEST_CASE("par::for_each") {
                                   }}),
                     ThreadError);
   }
+  SUBCASE("nested") {
+    // Ensure the nested loops over the large ranges visit each element once.
+    constexpr std::size_t num_slices = 4;
+    constexpr std::size_t slice_size = 16384;
+    std::vector<int> large(num_slices * slice_size);
+    par::for_each(std::views::iota(std::size_t{0}, num_slices),
+                  [&large](std::size_t slice) {
+                    par::for_each(std::span{large}.subspan(slice * slice_size,
+                                                           slice_size),
+                                  [](int& i) { i += 1; });
+                  });
+    CHECK(std::ranges::all_of(large, [](int i) { return i == 1; }));
+  }
+}
+
+TEST_CASE("par::numa_for_each") {
+  par::set_num_threads(4);
+  SUBCASE("small") {
+    // Ensure the loop is executed.
+    std::vector data{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    par::numa_for_each(data, [](int& i) { i += 1; });
+    CHECK(data == std::vector{1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  }
+  SUBCASE("large") {
+    // Ensure the large ranges, that may be distributed across the NUMA nodes,
+    // visit each element once.
+    std::vector<int> large(100000);
+    par::numa_for_each(large, [](int& i) { i += 1; });
+    CHECK(std::ranges::all_of(large, [](int i) { return i == 1; }));
+  }
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -96,6 +131,69 @@ TEST_CASE("par::fold") {
   }
 }
 
+TEST_CASE("par::deterministic_fold") {
+  SUBCASE("basic") {
+    par::set_num_threads(4);
+    const std::vector data{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    CHECK(par::deterministic_fold(data, 0) == 45);
+  }
+  SUBCASE("reproducible") {
+    // Ensure the floating-point result does not depend on the number of
+    // threads.
+    const auto data = std::views::iota(1, 100001) |
+                      std::views::transform([](int i) { return 1.0 / i; }) |
+                      std::ranges::to<std::vector>();
+    par::set_num_threads(1);
+    const auto result_1 = par::deterministic_fold(data, 0.0);
+    par::set_num_threads(4);
+    const auto result_4 = par::deterministic_fold(data, 0.0);
+    CHECK(bitwise_equal(result_1, result_4));
+  }
+}
+
+TEST_CASE("par::deterministic_sum") {
+  par::set_num_threads(4);
+  SUBCASE("pairwise") {
+    const auto data = std::views::iota(std::int64_t{0}, std::int64_t{100000}) |
+                      std::ranges::to<std::vector>();
+    CHECK(par::deterministic_sum(data) == 4999950000);
+    CHECK(par::deterministic_sum(data, std::int64_t{50}) == 4999950050);
+  }
+  SUBCASE("kahan") {
+    // Tiny values of the first block are lost in the plain summation.
+    std::vector data(100000, 1.0e-16);
+    data.front() = 1.0;
+    const auto result = par::deterministic_sum(data, 0.0, par::SumMode::kahan);
+    CHECK(approx_equal_to(result, 1.0 + 99999 * 1.0e-16, 1.0e-15));
+  }
+  SUBCASE("projection") {
+    const std::vector data{1, 2, 3, 4};
+    CHECK(par::deterministic_sum(data,
+                                 0,
+                                 par::SumMode::pairwise,
+                                 [](int i) { return i * i; }) == 30);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("par::exclusive_scan") {
+  par::set_num_threads(4);
+  SUBCASE("basic") {
+    const std::vector data{1, 2, 3, 4, 5};
+    std::vector<int> out(data.size());
+    CHECK(par::exclusive_scan(data, out.begin(), 10) == 25);
+    CHECK_RANGE_EQ(out, {10, 11, 13, 16, 20});
+  }
+  SUBCASE("in-place") {
+    // Ensure the large ranges are scanned correctly in-place.
+    std::vector<std::size_t> data(100000, 1);
+    CHECK(par::exclusive_scan(data, data.begin()) == data.size());
+    CHECK(std::ranges::equal(data,
+                             std::views::iota(std::size_t{0}, data.size())));
+  }
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 TEST_CASE("par::unstable_copy_if") {
@@ -126,5 +224,185 @@ TEST_CASE("par::unstable_copy_if") {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+TEST_CASE("par::stable_copy_if") {
+  par::set_num_threads(4);
+  SUBCASE("basic") {
+    const std::vector data{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::vector<int> out(data.size());
+    const auto iter = par::stable_copy_if(data, out.begin(), [](int i) {
+      return i % 2 == 0;
+    });
+    CHECK_RANGE_EQ(std::ranges::subrange(out.begin(), iter), {0, 2, 4, 6, 8});
+  }
+  SUBCASE("large") {
+    // Ensure the order is preserved across the blocks.
+    const auto data = std::views::iota(0, 100000);
+    std::vector<int> out(data.size());
+    const auto pred = [](int i) { return i % 3 == 0; };
+    const auto iter = par::stable_copy_if(data, out.begin(), pred);
+    CHECK(std::ranges::equal(std::ranges::subrange(out.begin(), iter),
+                             data | std::views::filter(pred)));
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("par::partition") {
+  par::set_num_threads(4);
+  SUBCASE("small") {
+    // Ensure the range is partitioned and the relative order is preserved.
+    std::vector data{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    const auto right = par::partition(data, [](int i) { return i % 2 == 0; });
+    CHECK(right.begin() == data.begin() + 5);
+    CHECK_RANGE_EQ(data, {0, 2, 4, 6, 8, 1, 3, 5, 7, 9});
+  }
+  SUBCASE("large") {
+    // Ensure the range that spans multiple blocks is partitioned and the
+    // relative order is preserved.
+    const auto pred = [](int i) { return i % 3 == 0; };
+    auto data = std::views::iota(0, 100000) | std::ranges::to<std::vector>();
+    auto expected = data;
+    std::ranges::stable_partition(expected, pred);
+    const auto right = par::partition(data, pred);
+    CHECK(right.begin() == data.begin() + 33334);
+    CHECK_RANGE_EQ(data, expected);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("par::histogram") {
+  par::set_num_threads(4);
+  std::vector<std::size_t> counts(7, 123);
+  SUBCASE("basic") {
+    const auto data = std::views::iota(0, 1000);
+    par::histogram(data, counts, [](int i) { return i % 7; });
+    CHECK_RANGE_EQ(counts, {143, 143, 143, 143, 143, 143, 142});
+  }
+  SUBCASE("empty") {
+    const auto data = std::views::iota(0, 0);
+    par::histogram(data, counts, [](int i) { return i % 7; });
+    CHECK_RANGE_EQ(counts, {0, 0, 0, 0, 0, 0, 0});
+  }
+  SUBCASE("many blocks") {
+    const auto data = std::views::iota(0, 100000);
+    par::histogram(data, counts, [](int i) { return i % 7; });
+    CHECK_RANGE_EQ(counts,
+                   {14286, 14286, 14286, 14286, 14286, 14285, 14285});
+  }
+  SUBCASE("many bins") {
+    // Number of bins is large enough to count the elements atomically.
+    const auto data = std::views::iota(0, 100000);
+    std::vector<std::size_t> many_counts(1000, 123);
+    par::histogram(data, many_counts, [](int i) { return i % 1000; });
+    CHECK(std::ranges::all_of(many_counts,
+                              [](std::size_t count) { return count == 100; }));
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("par::sort") {
+  par::set_num_threads(4);
+  std::vector data{7, 3, 9, 0, 5, 1, 8, 2, 6, 4};
+  SUBCASE("basic") {
+    // Ensure the range is sorted.
+    par::sort(data);
+    CHECK_RANGE_EQ(data, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  }
+  SUBCASE("comparator and projection") {
+    // Ensure the comparator and projection are applied.
+    par::sort(data, std::ranges::greater{}, [](int i) { return i % 5; });
+    CHECK(std::ranges::is_sorted(data, std::ranges::greater{}, [](int i) {
+      return i % 5;
+    }));
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("par::radix_sort_by_key") {
+  par::set_num_threads(4);
+  SUBCASE("small") {
+    // Ensure the keys are sorted and the values follow the keys.
+    std::vector<unsigned> keys{3, 1, 2, 1, 0, 3};
+    std::vector vals{0, 1, 2, 3, 4, 5};
+    par::radix_sort_by_key(keys, vals);
+    CHECK_RANGE_EQ(keys, {0, 1, 1, 2, 3, 3});
+    CHECK_RANGE_EQ(vals, {4, 1, 3, 2, 0, 5});
+  }
+  SUBCASE("large") {
+    // Ensure the range that spans multiple blocks and multiple passes is
+    // sorted stably.
+    constexpr std::size_t size = 100000;
+    std::vector<std::uint64_t> keys(size);
+    for (std::size_t i = 0; i < size; ++i) keys[i] = (i * 7919) % 65537;
+    auto vals = std::views::iota(std::size_t{0}, size) |
+                std::ranges::to<std::vector>();
+    auto expected_vals = vals;
+    std::ranges::stable_sort(expected_vals, std::less{}, [&keys](auto i) {
+      return keys[i];
+    });
+    par::radix_sort_by_key(keys, vals);
+    CHECK(std::ranges::is_sorted(keys));
+    CHECK_RANGE_EQ(vals, expected_vals);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("par::sort_by_key") {
+  par::set_num_threads(4);
+  SUBCASE("small") {
+    std::vector keys{3, 1, 2, 1, 0, 3};
+    std::vector vals{0, 1, 2, 3, 4, 5};
+    par::sort_by_key(keys, vals, std::ranges::greater{});
+    CHECK_RANGE_EQ(keys, {3, 3, 2, 1, 1, 0});
+    CHECK_RANGE_EQ(vals, {0, 5, 2, 1, 3, 4});
+  }
+  SUBCASE("large") {
+    // Ensure the sort is stable.
+    std::vector<int> keys(100000);
+    std::vector<int> vals(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = static_cast<int>((i * 7919) % 1021);
+      vals[i] = static_cast<int>(i);
+    }
+    auto expected = std::views::zip(keys, vals) |
+                    std::ranges::to<std::vector<std::pair<int, int>>>();
+    std::ranges::stable_sort(expected, {}, [](const auto& key_and_val) {
+      return key_and_val.first;
+    });
+    par::sort_by_key(keys, vals);
+    CHECK(std::ranges::equal(keys, expected | std::views::keys));
+    CHECK(std::ranges::equal(vals, expected | std::views::values));
+  }
+}
+
+TEST_CASE("par::unstable_counting_sort") {
+  par::set_num_threads(4);
+  const auto data = std::views::iota(0, 1000);
+  const auto bin_func = [](int i) { return i % 7; };
+  std::vector<std::size_t> bin_offsets(8);
+  std::vector<int> out(data.size());
+  const auto iter =
+      par::unstable_counting_sort(data, bin_offsets, out.begin(), bin_func);
+  CHECK(iter == out.end());
+  CHECK_RANGE_EQ(bin_offsets, {0, 143, 286, 429, 572, 715, 858, 1000});
+  for (std::size_t bin = 0; bin < 7; ++bin) {
+    auto bin_range = std::ranges::subrange(
+        out.begin() + static_cast<std::ptrdiff_t>(bin_offsets[bin]),
+        out.begin() + static_cast<std::ptrdiff_t>(bin_offsets[bin + 1]));
+    std::ranges::sort(bin_range);
+    CHECK(std::ranges::equal(
+        bin_range,
+        data | std::views::filter([bin, &bin_func](int i) {
+          return static_cast<std::size_t>(bin_func(i)) == bin;
+        })));
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace
 } // namespace tit
@@ -82,6 +82,24 @@ inline auto fetch_and_add(Val& val, difference_t<Val> delta) noexcept -> Val {
   return __atomic_fetch_add(&val, delta, std::to_underlying(Order));
 }
 
+/// Atomically perform minimum and return what was stored before.
+template<MemOrder Order = MemOrder::relaxed, atomic Val>
+[[gnu::always_inline]]
+inline auto fetch_and_min(Val& val, std::type_identity_t<Val> desired) noexcept
+    -> Val {
+  auto current = load<MemOrder::relaxed>(val);
+  while (desired < current &&
+         !__atomic_compare_exchange_n(&val,
+                                      &current,
+                                      desired,
+                                      /*weak=*/true,
+                                      std::to_underlying(Order),
+                                      std::to_underlying(MemOrder::relaxed))) {
+    // Try again with the freshly loaded value.
+  }
+  return current;
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace tit::par
@@ -65,6 +65,22 @@ TEST_CASE("par::fetch_and_add") {
   CHECK(val == init + delta);
 }
 
+TEST_CASE("par::fetch_and_min") {
+  constexpr auto init = 10;
+  SUBCASE("smaller") {
+    constexpr auto desired = 5;
+    auto val = init;
+    CHECK(par::fetch_and_min(val, desired) == init);
+    CHECK(val == desired);
+  }
+  SUBCASE("greater") {
+    constexpr auto desired = 20;
+    auto val = init;
+    CHECK(par::fetch_and_min(val, desired) == init);
+    CHECK(val == init);
+  }
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace
@@ -3,13 +3,22 @@
  * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <list>
 #include <optional>
+#include <vector>
 
 #include <oneapi/tbb/global_control.h>
+#include <oneapi/tbb/info.h>
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+#include <oneapi/tbb/task_scheduler_observer.h>
 
 #include "tit/core/assert.hpp"
 #include "tit/core/env.hpp"
+#include "tit/core/math.hpp"
 #include "tit/core/sys_info.hpp"
 #include "tit/par/control.hpp"
 
@@ -17,8 +26,76 @@ namespace tit::par {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+namespace {
+
+// NUMA node of the arena the current thread is executing in.
+thread_local std::optional<std::size_t> current_numa_node_{};
+
+// Observer that tracks the threads that enter the NUMA node arena.
+class NumaObserver final : public tbb::task_scheduler_observer {
+public:
+
+  NumaObserver(tbb::task_arena& arena, std::size_t node)
+      : tbb::task_scheduler_observer{arena}, node_{node} {
+    observe(true);
+  }
+
+  NumaObserver(NumaObserver&&) = delete;
+  auto operator=(NumaObserver&&) -> NumaObserver& = delete;
+  NumaObserver(const NumaObserver&) = delete;
+  auto operator=(const NumaObserver&) -> NumaObserver& = delete;
+
+  ~NumaObserver() override {
+    observe(false);
+  }
+
+  void on_scheduler_entry(bool /*is_worker*/) override {
+    current_numa_node_ = node_;
+  }
+
+  void on_scheduler_exit(bool /*is_worker*/) override {
+    current_numa_node_ = std::nullopt;
+  }
+
+private:
+
+  std::size_t node_;
+
+}; // class NumaObserver
+
+auto numa_arenas() -> std::vector<tbb::task_arena>& {
+  static std::vector<tbb::task_arena> arenas{};
+  return arenas;
+}
+
+auto numa_observers() -> std::list<NumaObserver>& {
+  static std::list<NumaObserver> observers{};
+  return observers;
+}
+
+} // namespace
+
 void init() {
   par::set_num_threads(get_env("TIT_NUM_THREADS", sys_info::cpu_perf_cores()));
+
+  // Pin the worker threads to the NUMA nodes, if there are multiple of them.
+  // Note: TBB reports the NUMA topology only if the "tbbbind" library is
+  //       available, otherwise a single node is reported.
+  if (!get_env("TIT_NUMA", true) || sys_info::numa_nodes() <= 1) return;
+  const auto nodes = tbb::info::numa_nodes();
+  if (nodes.size() <= 1) return;
+  const auto node_concurrency =
+      static_cast<int>(divide_up(num_threads(), nodes.size()));
+  auto& arenas = numa_arenas();
+  auto& observers = numa_observers();
+  observers.clear();
+  arenas.clear();
+  arenas.reserve(nodes.size());
+  for (const auto node : nodes) {
+    arenas.emplace_back(tbb::task_arena::constraints{node, node_concurrency});
+    arenas.back().initialize();
+    observers.emplace_back(arenas.back(), arenas.size() - 1);
+  }
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -37,4 +114,34 @@ void set_num_threads(std::size_t value) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+auto num_numa_nodes() noexcept -> std::size_t {
+  return std::max<std::size_t>(numa_arenas().size(), 1);
+}
+
+auto current_numa_node() noexcept -> std::optional<std::size_t> {
+  return current_numa_node_;
+}
+
+void for_each_numa_node(const std::function<void(std::size_t)>& func) {
+  auto& arenas = numa_arenas();
+  if (arenas.size() <= 1) {
+    func(0);
+    return;
+  }
+
+  // Submit the work into the arenas first, and only then wait for it, so that
+  // the nodes are processed concurrently.
+  std::vector<tbb::task_group> groups(arenas.size());
+  for (std::size_t node = 0; node < arenas.size(); ++node) {
+    arenas[node].execute([&func, &group = groups[node], node] {
+      group.run([&func, node] { func(node); });
+    });
+  }
+  for (std::size_t node = 0; node < arenas.size(); ++node) {
+    arenas[node].execute([&group = groups[node]] { group.wait(); });
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace tit::par
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
+#include <optional>
 
 namespace tit::par {
 
@@ -24,4 +26,19 @@ void set_num_threads(std::size_t value);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/// Get number of the NUMA nodes the worker threads are pinned to.
+/// If the worker threads are not pinned, one is returned.
+auto num_numa_nodes() noexcept -> std::size_t;
+
+/// Get index of the NUMA node, which task arena the current thread is
+/// executing in, if any. Every thread of the node arena reports the node,
+/// including the threads that execute the stolen nested tasks.
+auto current_numa_node() noexcept -> std::optional<std::size_t>;
+
+/// Invoke the function for each NUMA node index in parallel. Each invocation
+/// runs in the task arena, which worker threads are pinned to the node.
+void for_each_numa_node(const std::function<void(std::size_t)>& func);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace tit::par
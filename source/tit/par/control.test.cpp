@@ -3,6 +3,11 @@
  * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
 #include "tit/par/control.hpp"
 #include "tit/testing/test.hpp"
 
@@ -20,6 +25,23 @@ TEST_CASE("par::num_threads") {
   CHECK(par::num_threads() == 3);
 }
 
+TEST_CASE("par::for_each_numa_node") {
+  const auto num_nodes = par::num_numa_nodes();
+  std::vector<std::size_t> counts(num_nodes);
+  std::vector<std::optional<std::size_t>> current_nodes(num_nodes);
+  par::for_each_numa_node([&counts, &current_nodes](std::size_t node) {
+    counts[node] += 1;
+    current_nodes[node] = par::current_numa_node();
+  });
+  CHECK(std::ranges::all_of(counts, [](std::size_t c) { return c == 1; }));
+  for (std::size_t node = 0; node < num_nodes; ++node) {
+    // Without the pinning, there are no node arenas.
+    if (num_nodes > 1) CHECK(current_nodes[node] == node);
+    else CHECK_FALSE(current_nodes[node].has_value());
+  }
+  CHECK_FALSE(par::current_numa_node().has_value());
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 } // namespace
@@ -0,0 +1,99 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "tit/core/memory.hpp"
+
+namespace tit::par {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Tag for the values that are left uninitialized by the first-touch
+/// allocator.
+struct Uninitialized final {};
+
+/// @copydoc Uninitialized
+inline constexpr Uninitialized uninitialized{};
+
+/// Values that may be left uninitialized by the first-touch allocator.
+template<class Val>
+concept uninitializable = std::is_trivially_copyable_v<Val> &&
+                          std::is_trivially_destructible_v<Val>;
+
+/// Allocator that may leave the trivially copyable values uninitialized.
+///
+/// Values are constructed as usual, unless they are explicitly constructed
+/// from the `uninitialized` tag (see `resize_for_overwrite`). Memory pages of
+/// such values are not touched by the container, so that they could be first
+/// touched by the worker threads, and placed on the corresponding NUMA nodes.
+/// Large allocations are backed by the huge pages, if they are enabled.
+///
+/// @note Allocator is not final, since the standard containers may derive
+///       from their allocators.
+template<class Val>
+class FirstTouchAllocator : public std::allocator<Val> {
+public:
+
+  /// Construct an allocator.
+  constexpr FirstTouchAllocator() noexcept = default;
+
+  /// Construct an allocator from the allocator of a different type.
+  template<class Other>
+  constexpr explicit(false) FirstTouchAllocator(
+      const FirstTouchAllocator<Other>& /*other*/) noexcept {}
+
+  /// Allocate memory for the values.
+  auto allocate(std::size_t count) -> Val* {
+    return static_cast<Val*>(
+        allocate_huge(count * sizeof(Val), alignof(Val)));
+  }
+
+  /// Allocate memory for at least the specified number of values.
+  auto allocate_at_least(std::size_t count) -> std::allocation_result<Val*> {
+    return {allocate(count), count};
+  }
+
+  /// Deallocate memory for the values.
+  void deallocate(Val* ptr, std::size_t count) noexcept {
+    deallocate_huge(ptr, count * sizeof(Val), alignof(Val));
+  }
+
+  /// Leave the value uninitialized. Value is implicitly created by the
+  /// allocation, since it is trivially copyable.
+  template<uninitializable Other>
+  constexpr void construct(Other* /*ptr*/, Uninitialized /*tag*/) noexcept {}
+
+  /// Construct the value from the arguments.
+  template<class Other, class... Args>
+    requires (!std::same_as<std::remove_cvref_t<Args>, Uninitialized> && ...)
+  constexpr void construct(Other* ptr, Args&&... args) {
+    std::construct_at(ptr, std::forward<Args>(args)...);
+  }
+
+}; // class FirstTouchAllocator
+
+/// Resize the container that uses the first-touch allocator. Appended values
+/// are left uninitialized, and must be overwritten by the caller.
+template<class Container>
+  requires uninitializable<typename Container::value_type>
+constexpr void resize_for_overwrite(Container& container, std::size_t size) {
+  if (size <= container.size()) {
+    container.resize(size);
+    return;
+  }
+  container.reserve(size);
+  while (container.size() < size) container.emplace_back(uninitialized);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::par
@@ -0,0 +1,50 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <algorithm>
+#include <cstddef>
+#include <ranges>
+#include <vector>
+
+#include "tit/core/vec.hpp"
+#include "tit/par/memory.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+template<class Val>
+using Vector = std::vector<Val, par::FirstTouchAllocator<Val>>;
+
+TEST_CASE("par::FirstTouchAllocator") {
+  SUBCASE("default construction") {
+    // Default-constructed values are initialized as usual.
+    Vector<Vec<double, 3>> vecs(3, Vec<double, 3>{1.0, 2.0, 3.0});
+    vecs.resize(10);
+    CHECK(vecs[0] == Vec<double, 3>{1.0, 2.0, 3.0});
+    CHECK(std::ranges::all_of(vecs | std::views::drop(3), [](const auto& v) {
+      return v == Vec<double, 3>{};
+    }));
+    Vector<int> ints(5);
+    CHECK(std::ranges::all_of(ints, [](int i) { return i == 0; }));
+  }
+  SUBCASE("resize for overwrite") {
+    // Existing values are kept, new values must be overwritten.
+    Vector<int> ints{1, 2, 3};
+    par::resize_for_overwrite(ints, 1000);
+    REQUIRE(ints.size() == 1000);
+    CHECK(ints[0] == 1);
+    CHECK(ints[2] == 3);
+    par::resize_for_overwrite(ints, 2);
+    CHECK(ints == Vector<int>{1, 2});
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
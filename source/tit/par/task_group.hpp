@@ -6,14 +6,19 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <span>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <oneapi/tbb/task_group.h>
 
 #include "tit/core/assert.hpp"
+#include "tit/par/atomic.hpp"
 
 namespace tit::par {
 
@@ -64,4 +69,82 @@ private:
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/// Parallel task graph.
+///
+/// Each task is started as soon as all the tasks it depends on are finished,
+/// so that the independent tasks are executed concurrently. Graph can be run
+/// multiple times.
+class TaskGraph final {
+public:
+
+  /// Add a task to the graph.
+  ///
+  /// @param deps Indices of the previously added tasks that must be finished
+  ///             before the task is started.
+  ///
+  /// @returns Index of the added task.
+  template<class Task>
+    requires task<Task&&>
+  auto add(Task&& task, std::span<const std::size_t> deps = {})
+      -> std::size_t {
+    const auto index = nodes_.size();
+    for (const auto dep : deps) {
+      TIT_ASSERT(dep < index, "Dependency must be added before the task!");
+      nodes_[dep].successors.push_back(index);
+    }
+    nodes_.push_back({.task = std::forward<Task>(task),
+                      .successors = {},
+                      .num_deps = static_cast<std::ptrdiff_t>(deps.size())});
+    return index;
+  }
+
+  /// Number of the tasks in the graph.
+  auto size() const noexcept -> std::size_t {
+    return nodes_.size();
+  }
+
+  /// Run the graph and wait for all the tasks to finish.
+  void run() {
+    std::vector<std::ptrdiff_t> num_pending_deps(nodes_.size());
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+      num_pending_deps[i] = nodes_[i].num_deps;
+    }
+
+    // Run the task, and then start the successors that have no more pending
+    // dependencies. The last finished dependency starts the successor.
+    TaskGroup group{};
+    const auto run_node = [&group, &num_pending_deps, this](
+                              this const auto& self,
+                              std::size_t index) -> void {
+      group.run([&self, &num_pending_deps, index, this] {
+        const auto& node = nodes_[index];
+        std::invoke(node.task);
+        for (const auto successor : node.successors) {
+          const auto prev = fetch_and_add<MemOrder::acq_rel>(
+              num_pending_deps[successor],
+              -1);
+          if (prev == 1) self(successor);
+        }
+      });
+    };
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+      if (nodes_[i].num_deps == 0) run_node(i);
+    }
+    group.wait();
+  }
+
+private:
+
+  struct Node_ final {
+    std::function<void()> task;
+    std::vector<std::size_t> successors;
+    std::ptrdiff_t num_deps;
+  };
+
+  std::vector<Node_> nodes_;
+
+}; // class TaskGraph
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace tit::par
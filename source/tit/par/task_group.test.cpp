@@ -3,8 +3,12 @@
  * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <cstddef>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
+#include "tit/par/atomic.hpp"
 #include "tit/par/control.hpp"
 #include "tit/par/task_group.hpp"
 #include "tit/testing/test.hpp"
@@ -67,5 +71,43 @@ TEST_CASE("par::TaskGroup") {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+TEST_CASE("par::TaskGraph") {
+  par::set_num_threads(4);
+  SUBCASE("dependencies") {
+    // Build a diamond-shaped graph, and record the order of the tasks.
+    par::TaskGraph graph{};
+    std::vector<std::size_t> order(4);
+    std::size_t counter = 0;
+    const auto record = [&order, &counter](std::size_t task) {
+      return SleepFunc{[&order, &counter, task] {
+        order[task] = par::fetch_and_add(counter, 1);
+      }};
+    };
+    const auto a = graph.add(record(0));
+    const auto b = graph.add(record(1), {a});
+    const auto c = graph.add(record(2), {a});
+    graph.add(record(3), {b, c});
+    REQUIRE(graph.size() == 4);
+
+    // Run the graph twice to ensure it can be reused.
+    for (std::size_t run = 0; run < 2; ++run) {
+      counter = 0;
+      graph.run();
+      CHECK(counter == 4);
+      CHECK(order[0] == 0);
+      CHECK(order[3] == 3);
+    }
+  }
+  SUBCASE("exceptions") {
+    // Ensure the exceptions from the tasks are propagated.
+    par::TaskGraph graph{};
+    const auto a = graph.add([] { throw std::runtime_error{"Task failed!"}; });
+    graph.add([] { FAIL("Task should not be executed!"); }, {a});
+    CHECK_THROWS_WITH_AS(graph.run(), "Task failed!", std::runtime_error);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace
 } // namespace tit
@@ -106,16 +106,48 @@ inline constexpr bool is_field_set_v<TypeSet<Fields...>> = true;
 template<class FieldSet>
 concept field_set = impl::is_field_set_v<FieldSet>;
 
+/// Transient field specification type.
+template<class Field>
+concept transient_field = field<Field> && Field::is_transient;
+
+/// Subset of the transient fields.
+template<field... Fields>
+consteval auto transient_subset(TypeSet<Fields...> /*fields*/) noexcept {
+  return (TypeSet{} | ... | [] {
+    if constexpr (transient_field<Fields>) return TypeSet<Fields>{};
+    else return TypeSet{};
+  }());
+}
+
+/// Output field specification type.
+template<class Field>
+concept output_field = field<Field> && Field::is_output;
+
+/// Subset of the output fields.
+template<field... Fields>
+consteval auto output_subset(TypeSet<Fields...> /*fields*/) noexcept {
+  return (TypeSet{} | ... | [] {
+    if constexpr (output_field<Fields>) return TypeSet<Fields>{};
+    else return TypeSet{};
+  }());
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-/// Declare a particle field.
-#define TIT_DEFINE_FIELD(name, ...)                                            \
+/// Declare a particle field with the specified liveness and visibility.
+#define TIT_DEFINE_FIELD_IMPL(name, transient, output, ...)                    \
   class name##_t final : public BaseField {                                    \
   public:                                                                      \
                                                                                \
     /** Field name. */                                                         \
     static constexpr std::string_view field_name = #name;                      \
                                                                                \
+    /** Is the field live only inside a single phase? */                       \
+    static constexpr bool is_transient = transient;                            \
+                                                                               \
+    /** Is the field written into the output? */                               \
+    static constexpr bool is_output = output;                                  \
+                                                                               \
     /** Field type. */                                                         \
     template<class Real, size_t Dim>                                           \
       requires (std::same_as<__VA_ARGS__, Real> ||                             \
@@ -126,6 +158,10 @@ concept field_set = impl::is_field_set_v<FieldSet>;
   }; /* class name##_t */                                                      \
   inline constexpr name##_t name
 
+/// Declare a particle field.
+#define TIT_DEFINE_FIELD(name, ...)                                            \
+  TIT_DEFINE_FIELD_IMPL(name, false, true, __VA_ARGS__)
+
 /// Declare a scalar particle field.
 #define TIT_DEFINE_SCALAR_FIELD(name) TIT_DEFINE_FIELD(name, Real)
 
@@ -135,6 +171,41 @@ concept field_set = impl::is_field_set_v<FieldSet>;
 /// Declare a matrix particle field.
 #define TIT_DEFINE_MATRIX_FIELD(name) TIT_DEFINE_FIELD(name, Mat<Real, Dim>)
 
+/// Declare a non-output particle field.
+///
+/// Non-output fields are stored permanently, but hold the internal state of
+/// the solver, and are not written into the output.
+#define TIT_DEFINE_NON_OUTPUT_FIELD(name, ...)                                 \
+  TIT_DEFINE_FIELD_IMPL(name, false, false, __VA_ARGS__)
+
+/// Declare a non-output scalar particle field.
+#define TIT_DEFINE_NON_OUTPUT_SCALAR_FIELD(name)                               \
+  TIT_DEFINE_NON_OUTPUT_FIELD(name, Real)
+
+/// Declare a non-output vector particle field.
+#define TIT_DEFINE_NON_OUTPUT_VECTOR_FIELD(name)                               \
+  TIT_DEFINE_NON_OUTPUT_FIELD(name, Vec<Real, Dim>)
+
+/// Declare a transient particle field.
+///
+/// Transient fields are live only inside a single phase of the equations.
+/// They are not stored permanently, and are backed by the shared scratch
+/// storage of the particle array while the phase is running.
+#define TIT_DEFINE_TRANSIENT_FIELD(name, ...)                                  \
+  TIT_DEFINE_FIELD_IMPL(name, true, false, __VA_ARGS__)
+
+/// Declare a transient scalar particle field.
+#define TIT_DEFINE_TRANSIENT_SCALAR_FIELD(name)                                \
+  TIT_DEFINE_TRANSIENT_FIELD(name, Real)
+
+/// Declare a transient vector particle field.
+#define TIT_DEFINE_TRANSIENT_VECTOR_FIELD(name)                                \
+  TIT_DEFINE_TRANSIENT_FIELD(name, Vec<Real, Dim>)
+
+/// Declare a transient matrix particle field.
+#define TIT_DEFINE_TRANSIENT_MATRIX_FIELD(name)                                \
+  TIT_DEFINE_TRANSIENT_FIELD(name, Mat<Real, Dim>)
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 /// Space specification.
@@ -184,7 +255,7 @@ TIT_DEFINE_VECTOR_FIELD(v);
 /// Particle acceleration.
 TIT_DEFINE_VECTOR_FIELD(dv_dt);
 /// Particle velocity gradient.
-TIT_DEFINE_MATRIX_FIELD(grad_v);
+TIT_DEFINE_TRANSIENT_MATRIX_FIELD(grad_v);
 
 /// Particle semi-analytical volume correction.
 TIT_DEFINE_SCALAR_FIELD(gamma);
@@ -194,7 +265,7 @@ TIT_DEFINE_VECTOR_FIELD(grad_gamma);
 /// Particle density.
 TIT_DEFINE_SCALAR_FIELD(rho);
 /// Particle density gradient.
-TIT_DEFINE_VECTOR_FIELD(grad_rho);
+TIT_DEFINE_TRANSIENT_VECTOR_FIELD(grad_rho);
 /// Particle density time derivative.
 TIT_DEFINE_SCALAR_FIELD(drho_dt);
 
@@ -204,18 +275,30 @@ TIT_DEFINE_SCALAR_FIELD(p);
 TIT_DEFINE_SCALAR_FIELD(cs);
 
 /// Particle normal vector.
-TIT_DEFINE_VECTOR_FIELD(N);
+TIT_DEFINE_TRANSIENT_VECTOR_FIELD(N);
 /// Particle renormalization matrix.
-TIT_DEFINE_MATRIX_FIELD(L);
+TIT_DEFINE_TRANSIENT_MATRIX_FIELD(L);
 namespace sph {
 /// Particle free surface indicator.
 TIT_DEFINE_SCALAR_FIELD(phi);
 } // namespace sph
 /// Particle shift.
-TIT_DEFINE_VECTOR_FIELD(dr);
+TIT_DEFINE_TRANSIENT_VECTOR_FIELD(dr);
 
 /// Scratch field for free surface correction.
-TIT_DEFINE_SCALAR_FIELD(rho_raw);
+TIT_DEFINE_TRANSIENT_SCALAR_FIELD(rho_raw);
+
+/// Particle position at the beginning of the time step.
+TIT_DEFINE_NON_OUTPUT_VECTOR_FIELD(r_n);
+/// Particle velocity at the beginning of the time step.
+TIT_DEFINE_NON_OUTPUT_VECTOR_FIELD(v_n);
+/// Particle density at the beginning of the time step.
+TIT_DEFINE_NON_OUTPUT_SCALAR_FIELD(rho_n);
+
+/// Particle position round-off error, for the compensated position update.
+TIT_DEFINE_NON_OUTPUT_VECTOR_FIELD(r_err);
+/// Particle position round-off error at the beginning of the time step.
+TIT_DEFINE_NON_OUTPUT_VECTOR_FIELD(r_err_n);
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -6,46 +6,63 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <numbers>
 #include <ranges>
+#include <span>
+#include <tuple>
 #include <utility>
 
+#include "tit/core/arena.hpp"
+#include "tit/core/assert.hpp"
+#include "tit/core/float.hpp"
 #include "tit/core/mat.hpp"
 #include "tit/core/math.hpp"
 #include "tit/core/profiler.hpp"
 #include "tit/core/type.hpp"
 #include "tit/core/vec.hpp"
 #include "tit/par/algorithms.hpp"
+#include "tit/par/atomic.hpp"
 #include "tit/sph/equation_of_state.hpp"
 #include "tit/sph/field.hpp"
 #include "tit/sph/kernel.hpp"
+#include "tit/sph/kernel_width.hpp"
 #include "tit/sph/particle_array.hpp"
 #include "tit/sph/particle_mesh.hpp"
+#include "tit/sph/step_graph.hpp"
 
 namespace tit::sph {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-/// Fluid equations with fixed kernel width and continuity equation.
+/// Fluid equations with continuity equation.
+///
+/// Kernel width is fixed by default. With adaptive kernel width, symmetric
+/// kernel width is used for the particle pairs.
 template<class Num,
          equation_of_state<Num> EquationOfState,
          kernel Kernel,
          class Domain,
-         class Containment>
+         class Containment,
+         kernel_width<Num> KernelWidth = FixedKernelWidth>
 class FluidEquations final {
 public:
 
   /// Set of particle fields that are required.
   static constexpr auto required_fields = //
       TypeSet{h, m, gamma, grad_gamma, rho, drho_dt, grad_rho, p, cs} |
-      TypeSet{v, dv_dt, grad_v, r, dr, L, N, phi, rho_raw};
+      TypeSet{v, dv_dt, grad_v, r, dr, L, N, phi, rho_raw} |
+      KernelWidth::required_fields;
 
   /// Set of particle fields that are modified.
   static constexpr auto modified_fields =
       TypeSet{m, gamma, grad_gamma, rho, drho_dt, grad_rho, p, cs} |
-      TypeSet{v, dv_dt, grad_v, r, dr, N, L, phi, rho_raw};
+      TypeSet{v, dv_dt, grad_v, r, dr, N, L, phi, rho_raw} |
+      KernelWidth::modified_fields;
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -58,15 +75,18 @@ public:
   /// @param containment Domain containment function.
   /// @param eos         Equation of state.
   /// @param kernel      Kernel.
+  /// @param width       Kernel width.
   explicit FluidEquations(Num g,
                           Num mu,
                           const Domain& domain,
                           const Containment& containment,
                           EquationOfState eos,
-                          Kernel kernel)
+                          Kernel kernel,
+                          KernelWidth width = {})
       : g_{g}, mu_{mu},                             //
         domain_{domain}, containment_{containment}, //
-        eos_{std::move(eos)}, kernel_{std::move(kernel)} {}
+        eos_{std::move(eos)}, kernel_{std::move(kernel)},
+        width_{std::move(width)} {}
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   //
@@ -94,13 +114,19 @@ public:
   //
 
   /// Refresh mesh and boundary state before evaluating equations.
+  ///
+  /// Mesh and gamma are refreshed only if the particle positions have
+  /// changed since the last refresh.
   template<particle_mesh ParticleMesh,
            particle_array<required_fields> ParticleArray>
   void prepare(ParticleMesh& mesh, ParticleArray& particles) const {
     TIT_PROFILE_SECTION("FluidEquations::prepare()");
 
-    index(mesh, particles);
-    compute_gamma(mesh, particles);
+    width_.update(particles);
+    if (!mesh.is_current(particles)) {
+      index(mesh, particles);
+      compute_gamma(mesh, particles);
+    }
     setup_boundary(mesh, particles);
   }
 
@@ -112,6 +138,11 @@ public:
   void index(ParticleMesh& mesh, ParticleArray& particles) const {
     using PV = ParticleView<ParticleArray>;
     mesh.update(domain_, particles, [this](PV a) { return kernel_.radius(a); });
+    mesh.update_face_fluxes(domain_,
+                            particles,
+                            [this](const auto& face, PV a) {
+                              return kernel_.flux(face, a);
+                            });
   }
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -175,8 +206,8 @@ public:
     par::for_each(particles.all(), [&mesh, this](PV a) {
       // Compute gamma gradient.
       grad_gamma[a] = {};
-      for (const auto& [s_face, _] : mesh[domain_, a]) {
-        grad_gamma[a] += kernel_.flux(s_face, a);
+      for (const auto& [_, grad_gamma_as] : mesh.face_fluxes(domain_, a)) {
+        grad_gamma[a] += grad_gamma_as;
       }
 
       // Compute gamma based on the containment function and fluxes.
@@ -204,21 +235,25 @@ public:
         particles.fluid(),
         std::numeric_limits<Num>::max(),
         [this](Num dt, PV a) {
-          // Acoustic time step.
-          const auto dt_acoustic =
-              CFL_ * h[a] /
-              (eos_.sound_speed_from_density(rho[a]) + norm(v[a]));
+          return std::min(dt, compute_local_time_step(a));
+        },
+        [](Num dt_a, Num dt_b) { return std::min(dt_a, dt_b); });
+  }
 
-          // Viscous time step.
-          const auto dt_visc = C_visc_ * pow2(h[a]) * rho[a] / mu_;
+  /// Compute the maximum allowed time step of the particle.
+  template<particle_view PV>
+  auto compute_local_time_step(PV a) const -> Num {
+    // Acoustic time step.
+    const auto dt_acoustic =
+        CFL_ * h[a] / (eos_.sound_speed_from_density(rho[a]) + norm(v[a]));
 
-          // Force time step.
-          const auto dt_force =
-              C_force_ * sqrt(h[a] / std::max(norm(dv_dt[a]), g_));
+    // Viscous time step.
+    const auto dt_visc = C_visc_ * pow2(h[a]) * rho[a] / mu_;
 
-          return std::min({dt, dt_acoustic, dt_visc, dt_force});
-        },
-        [](Num dt_a, Num dt_b) { return std::min(dt_a, dt_b); });
+    // Force time step.
+    const auto dt_force = C_force_ * sqrt(h[a] / std::max(norm(dv_dt[a]), g_));
+
+    return std::min({dt_acoustic, dt_visc, dt_force});
   }
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -230,78 +265,65 @@ public:
   template<particle_mesh ParticleMesh,
            particle_array<required_fields> ParticleArray>
   void compute_continuity(ParticleMesh& mesh, ParticleArray& particles) const {
-    TIT_PROFILE_SECTION("FluidEquations::compute_continuity()");
-    using PV = ParticleView<ParticleArray>;
-
-    // Compute sound speed from density.
-    par::for_each(particles.all(), [this](PV a) {
-      cs[a] = eos_.sound_speed_from_density(rho[a]);
-    });
-
-    // Compute density time derivative.
-    par::for_each(particles.fluid(), [&mesh, this](PV a) {
-      drho_dt[a] = {};
-      for (const auto& [s_face, s] : mesh[domain_, a]) {
-        const auto grad_gamma_as = kernel_.flux(s_face, a);
-        drho_dt[a] -= rho[s] * dot(v[a, s], grad_gamma_as) / gamma[a];
-      }
-    });
-    par::block_for_each(mesh.block_pairs(particles), [this](auto ab) {
-      const auto [a, b] = ab;
-      const auto grad_W_ab = kernel_.grad(a, b);
-
-      // Ferrari artificial density diffusion term (Ferrari et al., 2009).
-      const auto cs_ab = std::max(cs[a], cs[b]);
-      const auto Psi_ab = cs_ab * rho[a, b] * r[a, b] / norm(r[a, b]);
-
-      drho_dt[a] += m[b] / gamma[a] * dot(v[a, b] + Psi_ab / rho[b], grad_W_ab);
-      drho_dt[b] -= m[a] / gamma[b] * dot(v[b, a] + Psi_ab / rho[a], grad_W_ab);
-    });
+    compute_continuity(mesh, particles, all_active_);
   }
 
-  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// Compute continuity equation right-hand side only for the active
+  /// particles.
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray,
+           std::predicate<ParticleView<ParticleArray>> IsActive>
+  void compute_continuity(ParticleMesh& mesh,
+                          ParticleArray& particles,
+                          const IsActive& is_active) const {
+    TIT_PROFILE_SECTION("FluidEquations::compute_continuity()");
+    run_step_phases(continuity_phases_(mesh, particles, is_active));
+  }
 
   /// Compute momentum equation right-hand side.
   template<particle_mesh ParticleMesh,
            particle_array<required_fields> ParticleArray>
   void compute_momentum(ParticleMesh& mesh, ParticleArray& particles) const {
-    TIT_PROFILE_SECTION("FluidEquations::compute_momentum()");
-    using PV = ParticleView<ParticleArray>;
-
-    // Compute pressure from density.
-    par::for_each(particles.all(),
-                  [this](PV a) { p[a] = eos_.pressure_from_density(rho[a]); });
-
-    // Compute velocity time derivative.
-    par::for_each(particles.fluid(), [&mesh, this](PV a) {
-      dv_dt[a] = unit<1>(r[a], -g_);
-      for (const auto& [s_face, s] : mesh[domain_, a]) {
-        const auto grad_gamma_as = kernel_.flux(s_face, a);
-
-        const auto P_as = rho[s] * (p[a] / pow2(rho[a]) + p[s] / pow2(rho[s]));
-
-        const auto n_s = normalize(grad_gamma_as);
-        const auto t_as = normalize(v[a, s] - dot(v[a, s], n_s) * n_s);
-        const auto dr_as = std::max(h[a] / 2, dot(r[a, s], n_s));
-        const auto Pi_as =
-            2 * mu_ / (rho[a] * dr_as) * dot(v[a, s], t_as) * t_as;
-
-        dv_dt[a] +=
-            (P_as * grad_gamma_as - Pi_as * norm(grad_gamma_as)) / gamma[a];
-      }
-    });
-    par::block_for_each(mesh.block_pairs(particles), [this](auto ab) {
-      const auto [a, b] = ab;
-      const auto grad_W_ab = kernel_.grad(a, b);
+    compute_momentum(mesh, particles, all_active_);
+  }
 
-      const auto P_ab = p[a] / pow2(rho[a]) + p[b] / pow2(rho[b]);
+  /// Compute momentum equation right-hand side only for the active
+  /// particles.
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray,
+           std::predicate<ParticleView<ParticleArray>> IsActive>
+  void compute_momentum(ParticleMesh& mesh,
+                        ParticleArray& particles,
+                        const IsActive& is_active) const {
+    TIT_PROFILE_SECTION("FluidEquations::compute_momentum()");
+    run_step_phases(momentum_phases_(mesh, particles, is_active));
+  }
 
-      const auto Pi_ab =
-          2 * mu_ * dot(v[a, b], r[a, b]) / (rho[a] * rho[b] * norm2(r[a, b]));
+  /// Compute continuity and momentum equations right-hand sides.
+  ///
+  /// Equivalent to `compute_continuity` followed by `compute_momentum`, but
+  /// the independent phases of both equations are executed concurrently.
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray>
+  void compute_rhs(ParticleMesh& mesh, ParticleArray& particles) const {
+    compute_rhs(mesh, particles, all_active_);
+  }
 
-      dv_dt[a] += m[b] / gamma[a] * (Pi_ab - P_ab) * grad_W_ab;
-      dv_dt[b] -= m[a] / gamma[b] * (Pi_ab - P_ab) * grad_W_ab;
-    });
+  /// Compute continuity and momentum equations right-hand sides only for the
+  /// active particles.
+  ///
+  /// Right-hand sides of the inactive particles are left unchanged, and the
+  /// particle pairs where both of the particles are inactive are skipped.
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray,
+           std::predicate<ParticleView<ParticleArray>> IsActive>
+  void compute_rhs(ParticleMesh& mesh,
+                   ParticleArray& particles,
+                   const IsActive& is_active) const {
+    TIT_PROFILE_SECTION("FluidEquations::compute_rhs()");
+    run_step_phases(
+        std::tuple_cat(continuity_phases_(mesh, particles, is_active),
+                       momentum_phases_(mesh, particles, is_active)));
   }
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -332,6 +354,10 @@ public:
     TIT_PROFILE_SECTION("FluidEquations::apply_shifts()");
     using PV = ParticleView<ParticleArray>;
 
+    // Normals, renormalization matrices, gradients and shifts are live only
+    // inside this phase.
+    const auto scratch = particles.scratch(TypeSet{N, L, grad_v, grad_rho, dr});
+
     // Compute normal vector, normalization matrix, and gradients for each
     // advected field.
     par::for_each(particles.all(), [&mesh, this](PV a) {
@@ -339,9 +365,7 @@ public:
       L[a] = {};
       grad_v[a] = {};
       grad_rho[a] = {};
-      for (const auto& [s_face, s] : mesh[domain_, a]) {
-        const auto grad_gamma_as = kernel_.flux(s_face, a);
-
+      for (const auto& [s, grad_gamma_as] : mesh.face_fluxes(domain_, a)) {
         N[a] -= grad_gamma_as / gamma[a];
         L[a] -= outer(r[s, a], grad_gamma_as) / gamma[a];
         grad_v[a] -= outer(v[s, a], grad_gamma_as) / gamma[a];
@@ -363,20 +387,22 @@ public:
       grad_rho[a] += V_b / gamma[a] * rho[b, a] * grad_W_ab;
       grad_rho[b] -= V_a / gamma[b] * rho[a, b] * grad_W_ab;
     });
+    // Invert the renormalization matrices in batches. Inverses of the
+    // near-singular matrices are replaced with the identity, so that the
+    // renormalization has no effect.
+    par::for_each_range(L[particles], [](const auto& block) {
+      const std::span L_block{block.begin(), block.end()};
+      inv_batch(std::span<const particle_field_t<L, PV>>{L_block}, L_block);
+    });
     par::for_each(particles.all(), [](PV a) {
       dr[a] = N[a];
-      if (const auto fact = lu(transpose(L[a]))) {
-        L[a] = fact->inverse();
-        N[a] = L[a] * N[a];
-        grad_v[a] = grad_v[a] * transpose(L[a]);
-        grad_rho[a] = L[a] * grad_rho[a];
-      } else {
-        L[a] = eye(L[a]);
-      }
-      N[a] = normalize(N[a]);
+      L[a] = transpose(L[a]);
+      N[a] = normalize(L[a] * N[a]);
+      grad_v[a] = grad_v[a] * transpose(L[a]);
+      grad_rho[a] = L[a] * grad_rho[a];
     });
 
-    // Initialize the free surface flag indicators.
+    // Free surface flag indicators:
     // - `phi_max = 1` means that the particle is far from the free surface.
     // - Any value in the range `(phi_min, phi_max)` means that the particle is
     //   near the free surface (has at least one neighbor that is on the free
@@ -385,74 +411,76 @@ public:
     //   essentially zero, but we use a very small number to avoid spurious
     //   comparisons.
     par::for_each(particles.fixed(), [](PV a) { phi[a] = phi_max_; });
-    par::for_each(particles.fluid(), [](PV a) { phi[a] = phi_min_; });
 
-    // Classify the particles into free surface and non-free surface.
-    //
-    // Here we are reading and writing the same field `phi` in the parallel
-    // loop. There is no race condition because we read the neighbor to compare
-    // it with `phi_min`, and non-free-surface particles are updated in the
-    // loop.
-    par::block_for_each(mesh.block_pairs(particles), [this](auto ab) {
-      const auto [a, b] = ab;
+    // Nearest free surface neighbor of each particle, encoded as the squared
+    // distance bits in the upper half and the neighbor index in the lower
+    // half, so that the keys can be reduced with a single atomic minimum.
+    TIT_ASSERT(particles.size() < no_fs_index_, "Too many particles!");
+    ArenaVector<std::uint64_t> fs_keys(particles.size(), no_fs_key_);
 
-      // Skip the particles that are too far away.
-      const auto r2_ab = norm2(r[a, b]);
-      const auto dist_threshold = avg(kernel_.radius(a), kernel_.radius(b));
-      if (r2_ab > pow2(dist_threshold)) return;
-
-      // Perform "visibility" test. The actual test is just an optimized
-      // version of `acos(n_{a,b} / sqrt(r_ab)) <= fov`.
-      constexpr auto cos_fov = static_cast<Num>(cos(std::numbers::pi / 4));
-      const auto fov_threshold = pow2(cos_fov) * r2_ab;
-      if (bitwise_equal(phi[a], phi_min_)) {
-        const auto n_a = dot(N[a], r[a, b]);
-        if (n_a > 0 && pow2(n_a) >= fov_threshold) phi[a] = phi_max_;
-      }
-      if (bitwise_equal(phi[b], phi_min_)) {
-        const auto n_b = dot(N[b], r[a, b]);
-        if (n_b < 0 && pow2(n_b) >= fov_threshold) phi[b] = phi_max_;
-      }
-    });
-
-    // Mark splashes as free surface particle.
-    par::for_each(particles.fluid(), [&mesh](PV a) {
+    // Classify the fluid particles into free surface and non-free surface,
+    // and let each free surface particle offer itself to its neighbors as
+    // the nearest free surface particle.
+    //
+    // Each particle writes only its own `phi`, so there is no race condition
+    // on the field. Neighbor keys are updated atomically.
+    par::for_each(particles.fluid(), [&mesh, &fs_keys, this](PV a) {
       // We shall consider a particle as a splash if it has:
       // - less than 8 neighbors in 2D and
       // - less than 26 neighbors in 3D.
+      // Mesh may be padded, so only the neighbors within the kernel radius
+      // are counted.
+      //
+      // Non-splash particle is not on the free surface if it can see some
+      // neighbor within its field of view. The actual "visibility" test is
+      // just an optimized version of `acos(n_{a,b} / sqrt(r_ab)) <= fov`.
+      //
+      // Both tests are performed in a single pass over the neighbors, which
+      // stops as soon as the outcome is known.
       static constexpr std::size_t neighbor_cutoff =
           particle_dim_v<PV> == 2 ? 8 : 26;
-      if (std::ranges::size(mesh[a]) <= neighbor_cutoff) phi[a] = phi_min_;
+      constexpr auto cos_fov = static_cast<Num>(cos(std::numbers::pi / 4));
+      const auto radius_a = kernel_.radius(a);
+      const auto radius2_a = pow2(radius_a);
+      std::size_t num_neighbors = 0;
+      bool sees_any = false;
+      for (const auto b : mesh[a]) {
+        const auto r2_ab = norm2(r[a, b]);
+        if (r2_ab <= radius2_a) num_neighbors += 1;
+        if (!sees_any && r2_ab <= pow2(avg(radius_a, kernel_.radius(b)))) {
+          const auto n_a = dot(N[a], r[a, b]);
+          sees_any = n_a > 0 && pow2(n_a) >= pow2(cos_fov) * r2_ab;
+        }
+        if (sees_any && num_neighbors > neighbor_cutoff) break;
+      }
+      if (sees_any && num_neighbors > neighbor_cutoff) {
+        phi[a] = phi_max_;
+        return;
+      }
+
+      phi[a] = phi_min_;
+      for (const auto b : mesh[a]) {
+        const auto r2_ab = static_cast<float32_t>(norm2(r[a, b]));
+        if (r2_ab > pow2(static_cast<float32_t>(kernel_.radius(b)))) continue;
+        const auto key = (std::uint64_t{std::bit_cast<std::uint32_t>(r2_ab)}
+                          << 32) |
+                         std::uint64_t{a.index()};
+        par::fetch_and_min(fs_keys[b.index()], key);
+      }
     });
 
-    // Classify the non-free surface particles into near and far categories.
-    //
-    // Here we are reading and writing the same field `phi` in the parallel
-    // loop. There is no race condition because we update the field only when
-    // the particle has `phi_min`, and read the field only to compare it with
-    // `phi_min`.
+    // Classify the non-free surface particles into near and far categories,
+    // then apply the particle shifts and correct fields.
     //
-    // A distinct non-zero bit pattern of `phi_min` is essential for
-    // correctness. We may read a garbage value while memory is being updated by
-    // some other thread, and the chances of a false positive comparison with
-    // distinct bits are very small, at least orders of magnitude smaller than
-    // if we used zero.
-    par::for_each(particles.fluid(), [&mesh, this](PV a) {
-      if (!bitwise_equal(phi[a], phi_max_)) return;
-
-      constexpr auto on_fs = [](PV b) {
-        return bitwise_equal(phi[b], phi_min_);
-      };
-      if (std::ranges::any_of(mesh[a], on_fs)) {
-        auto fs_neighbors = std::views::filter(mesh[a], on_fs);
-        const auto dist_to_a = [a](PV b) { return norm2(r[a, b]); };
-        const auto b = *std::ranges::min_element(fs_neighbors, {}, dist_to_a);
+    // Free surface particles are never shifted, so reading their positions
+    // while the other particles are being shifted is safe.
+    par::for_each(particles.fluid(), [&particles, &fs_keys, this](PV a) {
+      if (const auto key = fs_keys[a.index()];
+          bitwise_equal(phi[a], phi_max_) && key != no_fs_key_) {
+        const auto b = particles[key & no_fs_index_];
         phi[a] *= abs(dot(N[b], r[a, b])) / kernel_.radius(a);
       }
-    });
 
-    // Apply the particle shifts and correct fields.
-    par::for_each(particles.fluid(), [](PV a) {
       // Here we'll follow Leroy's PhD thesis (2014) and apply shifts only to
       // the far-away particles.
       if (!bitwise_equal(phi[a], phi_max_)) {
@@ -468,6 +496,14 @@ public:
       if (approx_equal_to(gamma[a], Num{1})) v[a] += grad_v[a] * dr[a];
       rho[a] += dot(grad_rho[a], dr[a]);
     });
+
+    // Shifts are small, so the padded mesh may survive them.
+    const auto max_shift = par::fold(
+        particles.fluid(),
+        Num{0},
+        [](Num shift, PV a) { return std::max(shift, norm(dr[a])); },
+        [](Num shift_a, Num shift_b) { return std::max(shift_a, shift_b); });
+    particles.touch(static_cast<float64_t>(max_shift));
   }
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -486,6 +522,9 @@ public:
     TIT_PROFILE_SECTION("FluidEquations::apply_free_surface_correction()");
     using PV = ParticleView<ParticleArray>;
 
+    // Raw density is live only inside this phase.
+    const auto scratch = particles.scratch(TypeSet{rho_raw});
+
     par::for_each(particles.all(), [](PV a) { rho_raw[a] = rho[a]; });
 
     par::for_each(particles.fluid(), [&mesh, this](PV a) {
@@ -515,12 +554,157 @@ public:
 
 private:
 
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray,
+           class IsActive>
+  auto continuity_phases_(ParticleMesh& mesh,
+                          ParticleArray& particles,
+                          const IsActive& is_active) const {
+    using PV = ParticleView<ParticleArray>;
+    return std::tuple{
+        // Compute sound speed from density.
+        StepPhase{TypeSet{rho},
+                  TypeSet{cs},
+                  [&particles, this] {
+                    par::for_each(particles.all(), [this](PV a) {
+                      cs[a] = eos_.sound_speed_from_density(rho[a]);
+                    });
+                  }},
+        // Compute density time derivative.
+        StepPhase{
+            TypeSet{h, r, v, rho, gamma},
+            TypeSet{drho_dt},
+            [&mesh, &particles, &is_active, this] {
+              par::for_each(particles.fluid(),
+                            [&mesh, &is_active, this](PV a) {
+                              if (!is_active(a)) return;
+                              drho_dt[a] = {};
+                              for (const auto& [s, grad_gamma_as] :
+                                   mesh.face_fluxes(domain_, a)) {
+                                drho_dt[a] -= rho[s] *
+                                              dot(v[a, s], grad_gamma_as) /
+                                              gamma[a];
+                              }
+                            });
+            }},
+        StepPhase{
+            TypeSet{h, m, r, v, rho, cs, gamma},
+            TypeSet{drho_dt},
+            [&mesh, &particles, &is_active, this] {
+              par::block_for_each(
+                  mesh.block_pairs(particles),
+                  [&is_active, this](auto ab) {
+                    const auto [a, b] = ab;
+                    const auto is_active_a = is_active(a);
+                    const auto is_active_b = is_active(b);
+                    if (!is_active_a && !is_active_b) return;
+                    const auto grad_W_ab = kernel_.grad(a, b);
+
+                    // Ferrari artificial density diffusion term (Ferrari et
+                    // al., 2009).
+                    const auto cs_ab = std::max(cs[a], cs[b]);
+                    const auto Psi_ab =
+                        cs_ab * rho[a, b] * r[a, b] / norm(r[a, b]);
+
+                    if (is_active_a) {
+                      drho_dt[a] += m[b] / gamma[a] *
+                                    dot(v[a, b] + Psi_ab / rho[b], grad_W_ab);
+                    }
+                    if (is_active_b) {
+                      drho_dt[b] -= m[a] / gamma[b] *
+                                    dot(v[b, a] + Psi_ab / rho[a], grad_W_ab);
+                    }
+                  });
+            }},
+    };
+  }
+
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray,
+           class IsActive>
+  auto momentum_phases_(ParticleMesh& mesh,
+                        ParticleArray& particles,
+                        const IsActive& is_active) const {
+    using PV = ParticleView<ParticleArray>;
+    return std::tuple{
+        // Compute pressure from density.
+        StepPhase{TypeSet{rho},
+                  TypeSet{p},
+                  [&particles, this] {
+                    par::for_each(particles.all(), [this](PV a) {
+                      p[a] = eos_.pressure_from_density(rho[a]);
+                    });
+                  }},
+        // Compute velocity time derivative.
+        StepPhase{
+            TypeSet{h, r, v, rho, p, gamma},
+            TypeSet{dv_dt},
+            [&mesh, &particles, &is_active, this] {
+              par::for_each(
+                  particles.fluid(),
+                  [&mesh, &is_active, this](PV a) {
+                    if (!is_active(a)) return;
+                    dv_dt[a] = unit<1>(r[a], -g_);
+                    for (const auto& [s, grad_gamma_as] :
+                         mesh.face_fluxes(domain_, a)) {
+                      const auto P_as =
+                          rho[s] * (p[a] / pow2(rho[a]) + p[s] / pow2(rho[s]));
+
+                      const auto n_s = normalize(grad_gamma_as);
+                      const auto t_as =
+                          normalize(v[a, s] - dot(v[a, s], n_s) * n_s);
+                      const auto dr_as = std::max(h[a] / 2, dot(r[a, s], n_s));
+                      const auto Pi_as = 2 * mu_ / (rho[a] * dr_as) *
+                                         dot(v[a, s], t_as) * t_as;
+
+                      dv_dt[a] += (P_as * grad_gamma_as -
+                                   Pi_as * norm(grad_gamma_as)) /
+                                  gamma[a];
+                    }
+                  });
+            }},
+        StepPhase{
+            TypeSet{h, m, r, v, rho, p, gamma},
+            TypeSet{dv_dt},
+            [&mesh, &particles, &is_active, this] {
+              par::block_for_each(
+                  mesh.block_pairs(particles),
+                  [&is_active, this](auto ab) {
+                    const auto [a, b] = ab;
+                    const auto is_active_a = is_active(a);
+                    const auto is_active_b = is_active(b);
+                    if (!is_active_a && !is_active_b) return;
+                    const auto grad_W_ab = kernel_.grad(a, b);
+
+                    const auto P_ab =
+                        p[a] / pow2(rho[a]) + p[b] / pow2(rho[b]);
+
+                    const auto Pi_ab = 2 * mu_ * dot(v[a, b], r[a, b]) /
+                                       (rho[a] * rho[b] * norm2(r[a, b]));
+
+                    if (is_active_a) {
+                      dv_dt[a] += m[b] / gamma[a] * (Pi_ab - P_ab) * grad_W_ab;
+                    }
+                    if (is_active_b) {
+                      dv_dt[b] -= m[a] / gamma[b] * (Pi_ab - P_ab) * grad_W_ab;
+                    }
+                  });
+            }},
+    };
+  }
+
+  static constexpr auto all_active_ = [](const auto& /*a*/) { return true; };
+
   static constexpr Num CFL_{0.4};
   static constexpr Num C_force_{0.25};
   static constexpr Num C_visc_{0.125};
   static constexpr Num C_shift_{0.2};
   static constexpr Num phi_max_{1};
   static constexpr Num phi_min_{std::numeric_limits<Num>::min()};
+  static constexpr std::uint64_t no_fs_key_{
+      std::numeric_limits<std::uint64_t>::max()};
+  static constexpr std::uint64_t no_fs_index_{
+      std::numeric_limits<std::uint32_t>::max()};
   static constexpr Num K_free_surface_{-log(Num{0.05}) / pow2(Num{0.01})};
 
   Num g_;
@@ -529,6 +713,7 @@ private:
   [[no_unique_address]] Containment containment_;
   [[no_unique_address]] EquationOfState eos_;
   [[no_unique_address]] Kernel kernel_;
+  [[no_unique_address]] KernelWidth width_;
 
 }; // class FluidEquations
 
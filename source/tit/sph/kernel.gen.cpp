@@ -349,12 +349,17 @@ public:
     return cutoff_;
   }
 
-  /// Weight polynomial `w(q)`.
-  auto value() const -> Expr {
+  /// Raw weight polynomial `w(q)`.
+  auto weight() const -> const Expr& {
     return weight_;
   }
 
-  /// Radial derivative `w'(q)`.
+  /// Weight polynomial `w(q)`, in Horner form around the cutoff.
+  auto value() const -> Expr {
+    return horner(weight_.subs(q, q + cutoff_), {q}).subs(q, q - cutoff_);
+  }
+
+  /// Radial derivative `w'(q)`, in Horner form around the cutoff.
   auto deriv() const -> Expr {
     const Poly poly{weight_, q};
     Expr result{0};
@@ -497,6 +502,25 @@ public:
     return segments_;
   }
 
+  /// Support pieces merged into the disjoint intervals: each interval ends
+  /// at its cutoff, starts at the previous one, and its weight polynomial is
+  /// the sum of all the pieces that cover it. In ascending order.
+  auto intervals() const -> std::vector<Segment> {
+    auto sorted = segments_;
+    std::ranges::sort(sorted, {}, [](const Segment& segment) {
+      return segment.cutoff().as_double();
+    });
+    std::vector<Segment> result;
+    for (const auto& [i, segment] : std::views::enumerate(sorted)) {
+      Expr weight{0};
+      for (const auto& other : sorted | std::views::drop(i)) {
+        weight += other.weight();
+      }
+      result.emplace_back(segment.cutoff(), weight);
+    }
+    return result;
+  }
+
   /// Support radius in units of the smoothing length (largest cutoff).
   auto unit_radius() const -> Expr {
     return std::ranges::max(segments_,
@@ -628,10 +652,10 @@ auto to_cxx(const Expr& e) -> std::string {
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 /// A support term guarded by its cutoff: `(q < cutoff ? expr : Num{0})`.
-auto truncated(const Segment& segment, const Expr& e) -> std::string {
+auto truncated(const Segment& segment, std::string_view expr) -> std::string {
   return std::format("(q < {} ? {} : Num{{0}})",
                      to_cxx(segment.cutoff()),
-                     to_cxx(e));
+                     expr);
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -677,7 +701,17 @@ void emit_helper(std::ostream& os,
 void emit_helpers(std::ostream& os, const Kernel& kernel) {
   std::println(os, "namespace impl::{}_gen {{", kernel.name());
   std::println(os);
+  for (const auto& [i, interval] : std::views::enumerate(kernel.intervals())) {
+    emit_helper(os, std::format("value_{}", i), {q}, OptExpr{interval.value()});
+    emit_helper(os, std::format("deriv_{}", i), {q}, OptExpr{interval.deriv()});
+  }
   for (const auto& [i, segment] : std::views::enumerate(kernel.segments())) {
+    for (const auto dim : {1, 2, 3}) {
+      emit_helper(os,
+                  std::format("antideriv_moment_{}_{}", dim, i),
+                  {q},
+                  OptExpr{segment.tail_moment(dim)});
+    }
     emit_helper(os,
                 std::format("unit_flux_{}", i),
                 {eta, z, rho, A, L},
@@ -723,38 +757,62 @@ void emit_radius(std::ostream& os, const Kernel& kernel) {
 }
 
 void emit_value(std::ostream& os, const Kernel& kernel) {
-  std::vector<std::string> terms;
-  for (const auto& segment : kernel.segments()) {
-    terms.emplace_back(truncated(segment, segment.value()));
-  }
   std::println(os, "template<>");
   std::println(os, "template<class Num>");
   std::println(os,
                "constexpr auto {}::unit_value(Num q) noexcept -> Num {{",
                kernel.name());
-  std::println(os, "  return {};", join_terms(terms));
+  for (const auto& [i, interval] : std::views::enumerate(kernel.intervals())) {
+    std::println(os,
+                 "  if (q < {}) return {}(q);",
+                 to_cxx(interval.cutoff()),
+                 helper_name(kernel, "value", i));
+  }
+  std::println(os, "  return Num{{0.0}};");
   std::println(os, "}}");
 }
 
 void emit_deriv(std::ostream& os, const Kernel& kernel) {
-  std::vector<std::string> terms;
-  for (const auto& segment : kernel.segments()) {
-    terms.emplace_back(truncated(segment, segment.deriv()));
-  }
   std::println(os, "template<>");
   std::println(os, "template<class Num>");
   std::println(os,
                "constexpr auto {}::unit_deriv(Num q) noexcept -> Num {{",
                kernel.name());
-  std::println(os, "  return {};", join_terms(terms));
+  for (const auto& [i, interval] : std::views::enumerate(kernel.intervals())) {
+    std::println(os,
+                 "  if (q < {}) return {}(q);",
+                 to_cxx(interval.cutoff()),
+                 helper_name(kernel, "deriv", i));
+  }
+  std::println(os, "  return Num{{0.0}};");
+  std::println(os, "}}");
+}
+
+void emit_value_and_deriv(std::ostream& os, const Kernel& kernel) {
+  std::println(os, "template<>");
+  std::println(os, "template<class Num>");
+  std::println(os,
+               "constexpr auto {}::unit_value_and_deriv(Num q) noexcept",
+               kernel.name());
+  std::println(os, "    -> std::pair<Num, Num> {{");
+  for (const auto& [i, interval] : std::views::enumerate(kernel.intervals())) {
+    std::println(os, "  if (q < {}) {{", to_cxx(interval.cutoff()));
+    std::println(os, "    return {{{}(q),", helper_name(kernel, "value", i));
+    std::println(os, "            {}(q)}};", helper_name(kernel, "deriv", i));
+    std::println(os, "  }}");
+  }
+  std::println(os, "  return {{Num{{0.0}}, Num{{0.0}}}};");
   std::println(os, "}}");
 }
 
 void emit_antideriv_moment(std::ostream& os, const Kernel& kernel) {
   const auto make_terms = [&kernel](int dim) {
     std::vector<std::string> terms;
-    for (const auto& segment : kernel.segments()) {
-      terms.emplace_back(truncated(segment, segment.tail_moment(dim)));
+    for (const auto& [i, segment] : std::views::enumerate(kernel.segments())) {
+      const auto name = std::format("antideriv_moment_{}", dim);
+      terms.emplace_back(
+          truncated(segment,
+                    std::format("{}(q)", helper_name(kernel, name, i))));
     }
     return terms;
   };
@@ -776,6 +834,112 @@ void emit_antideriv_moment(std::ostream& os, const Kernel& kernel) {
   std::println(os, "}}");
 }
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Emit the header of a SIMD overload, that takes and returns registers.
+void emit_simd_signature(std::ostream& os,
+                         const Kernel& kernel,
+                         std::string_view method,
+                         std::string_view result_type) {
+  std::println(os, "template<>");
+  std::println(os, "template<class Num, std::size_t Size>");
+  std::println(os,
+               "auto {}::{}(const simd::Reg<Num, Size>& q) noexcept",
+               kernel.name(),
+               method);
+  std::println(os, "    -> {} {{", result_type);
+  std::println(os, "  using Reg = simd::Reg<Num, Size>;");
+}
+
+/// Emit a SIMD overload of a piecewise function. Intervals are visited from
+/// the outermost one inwards, and the lanes are blended with masks, so that
+/// the result is computed without branches.
+void emit_simd_piecewise(std::ostream& os,
+                         const Kernel& kernel,
+                         std::string_view method,
+                         std::string_view helper) {
+  emit_simd_signature(os, kernel, method, "simd::Reg<Num, Size>");
+  std::println(os, "  Reg result{{}};");
+  const auto intervals = kernel.intervals();
+  for (const auto& [i, interval] :
+       std::views::enumerate(intervals) | std::views::reverse) {
+    std::println(os,
+                 "  result = simd::select(q < Reg{{{}}}, {}(q), result);",
+                 to_cxx(interval.cutoff()),
+                 helper_name(kernel, helper, i));
+  }
+  std::println(os, "  return result;");
+  std::println(os, "}}");
+}
+
+void emit_simd_value(std::ostream& os, const Kernel& kernel) {
+  emit_simd_piecewise(os, kernel, "unit_value", "value");
+}
+
+void emit_simd_deriv(std::ostream& os, const Kernel& kernel) {
+  emit_simd_piecewise(os, kernel, "unit_deriv", "deriv");
+}
+
+void emit_simd_value_and_deriv(std::ostream& os, const Kernel& kernel) {
+  emit_simd_signature(os,
+                      kernel,
+                      "unit_value_and_deriv",
+                      "std::pair<simd::Reg<Num, Size>, simd::Reg<Num, Size>>");
+  std::println(os, "  Reg value{{}};");
+  std::println(os, "  Reg deriv{{}};");
+  const auto intervals = kernel.intervals();
+  for (const auto& [i, interval] :
+       std::views::enumerate(intervals) | std::views::reverse) {
+    std::println(os, "  {{");
+    std::println(os,
+                 "    const auto mask = q < Reg{{{}}};",
+                 to_cxx(interval.cutoff()));
+    std::println(os,
+                 "    value = simd::select(mask, {}(q), value);",
+                 helper_name(kernel, "value", i));
+    std::println(os,
+                 "    deriv = simd::select(mask, {}(q), deriv);",
+                 helper_name(kernel, "deriv", i));
+    std::println(os, "  }}");
+  }
+  std::println(os, "  return {{value, deriv}};");
+  std::println(os, "}}");
+}
+
+void emit_simd_antideriv_moment(std::ostream& os, const Kernel& kernel) {
+  const auto emit_terms = [&os, &kernel](int dim) {
+    for (const auto& [i, segment] : std::views::enumerate(kernel.segments())) {
+      std::println(os,
+                   "    result += simd::filter(q < Reg{{{}}}, {}(q));",
+                   to_cxx(segment.cutoff()),
+                   helper_name(kernel,
+                               std::format("antideriv_moment_{}", dim),
+                               i));
+    }
+  };
+  std::println(os, "template<>");
+  std::println(os, "template<std::size_t Dim, class Num, std::size_t Size>");
+  std::println(os,
+               "auto {}::unit_antideriv_moment(const simd::Reg<Num, Size>& q)",
+               kernel.name());
+  std::println(os, "    noexcept -> simd::Reg<Num, Size> {{");
+  std::println(os, "  using Reg = simd::Reg<Num, Size>;");
+  std::println(os, "  Reg result{{}};");
+  std::println(os, "  if constexpr (Dim == 1) {{");
+  emit_terms(1);
+  std::println(os, "  }} else if constexpr (Dim == 2) {{");
+  emit_terms(2);
+  std::println(os, "  }} else if constexpr (Dim == 3) {{");
+  emit_terms(3);
+  std::println(os, "  }} else {{");
+  std::println(os, "    static_assert(false);");
+  std::println(os, "  }}");
+  std::println(os, "  return result;");
+  std::println(os, "}}");
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 void emit_segment_flux(std::ostream& os,
                        const Kernel& kernel,
                        std::string_view method) {
@@ -826,8 +990,18 @@ void emit_methods(std::ostream& os, const Kernel& kernel) {
   std::println(os);
   emit_deriv(os, kernel);
   std::println(os);
+  emit_value_and_deriv(os, kernel);
+  std::println(os);
   emit_antideriv_moment(os, kernel);
   std::println(os);
+  emit_simd_value(os, kernel);
+  std::println(os);
+  emit_simd_deriv(os, kernel);
+  std::println(os);
+  emit_simd_value_and_deriv(os, kernel);
+  std::println(os);
+  emit_simd_antideriv_moment(os, kernel);
+  std::println(os);
   emit_segment_flux(os, kernel, "unit_flux");
   std::println(os);
   emit_triangle_flux(os, kernel, "unit_flux");
@@ -848,8 +1022,10 @@ void emit_header(std::ostream& os) {
   std::println(os, "#pragma once");
   std::println(os);
   std::println(os, "#include <cstddef>");
+  std::println(os, "#include <utility>");
   std::println(os);
   std::println(os, R"(#include "tit/core/math.hpp")");
+  std::println(os, R"(#include "tit/core/simd.hpp")");
   std::println(os, R"(#include "tit/core/vec.hpp")");
   std::println(
       os,
@@ -8,9 +8,12 @@
 #include <algorithm>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <inplace_vector>
 #include <ranges>
+#include <utility>
+#include <vector>
 
 #include "tit/core/assert.hpp"
 #include "tit/core/math.hpp"
@@ -50,8 +53,8 @@ public:
   /// @{
   template<particle_view<required_fields> PV>
   constexpr auto operator()(this auto& self, PV a, PV b) noexcept {
-    static_assert(has_uniform<PV>(h));
-    return self(r[a, b], h[a]);
+    if constexpr (has_uniform<PV>(h)) return self(r[a, b], h[a]);
+    else return self(a, b, h.avg(a, b));
   }
   template<particle_view<required_fields> PV>
   constexpr auto operator()(this auto& self, PV a, PV b, auto h_ab) noexcept {
@@ -64,8 +67,8 @@ public:
   /// @{
   template<particle_view<required_fields> PV>
   constexpr auto grad(this auto& self, PV a, PV b) noexcept {
-    static_assert(has_uniform<PV>(h));
-    return self.grad(r[a, b], h[a]);
+    if constexpr (has_uniform<PV>(h)) return self.grad(r[a, b], h[a]);
+    else return self.grad(a, b, h.avg(a, b));
   }
   template<particle_view<required_fields> PV>
   constexpr auto grad(this auto& self, PV a, PV b, auto h_ab) noexcept {
@@ -74,12 +77,26 @@ public:
   }
   /// @}
 
+  /// Value and gradient of the smoothing kernel for two particles.
+  /// @{
+  template<particle_view<required_fields> PV>
+  constexpr auto eval(this auto& self, PV a, PV b) noexcept {
+    if constexpr (has_uniform<PV>(h)) return self.eval(r[a, b], h[a]);
+    else return self.eval(a, b, h.avg(a, b));
+  }
+  template<particle_view<required_fields> PV>
+  constexpr auto eval(this auto& self, PV a, PV b, auto h_ab) noexcept {
+    static_assert(!has_uniform<PV>(h));
+    return self.eval(r[a, b], h_ab);
+  }
+  /// @}
+
   /// Width derivative of the smoothing kernel for two points.
   /// @{
   template<particle_view<required_fields> PV>
   constexpr auto width_deriv(this auto& self, PV a, PV b) noexcept {
-    static_assert(has_uniform<PV>(h));
-    return self.width_deriv(r[a, b], h[a]);
+    if constexpr (has_uniform<PV>(h)) return self.width_deriv(r[a, b], h[a]);
+    else return self.width_deriv(a, b, h.avg(a, b));
   }
   template<particle_view<required_fields> PV>
   constexpr auto width_deriv(this auto& self, PV a, PV b, auto h_ab) noexcept {
@@ -92,8 +109,8 @@ public:
   /// @{
   template<particle_view<required_fields> PV>
   constexpr auto antigrad(this auto& self, PV a, PV b) noexcept {
-    static_assert(has_uniform<PV>(h));
-    return self.antigrad(r[a, b], h[a]);
+    if constexpr (has_uniform<PV>(h)) return self.antigrad(r[a, b], h[a]);
+    else return self.antigrad(a, b, h.avg(a, b));
   }
   template<particle_view<required_fields> PV>
   constexpr auto antigrad(this auto& self, PV a, PV b, auto h_ab) noexcept {
@@ -162,6 +179,24 @@ public:
     return w * self.unit_deriv(q) * grad_q;
   }
 
+  /// Value and spatial gradient of the smoothing kernel at point.
+  ///
+  /// Equivalent to evaluating the value and the gradient separately, but the
+  /// common terms are computed once.
+  template<class Num, std::size_t Dim, class Self>
+  constexpr auto eval(this Self& self, const Vec<Num, Dim>& x, Num h) noexcept
+      -> std::pair<Num, Vec<Num, Dim>> {
+    TIT_ASSERT(h > Num{0.0}, "Kernel width must be positive!");
+    const auto h_inverse = inverse(h);
+    const auto w = self.template weight<Num, Dim>() * pow<Dim>(h_inverse);
+    const auto x_norm = norm(x);
+    const auto q = h_inverse * x_norm;
+    const auto [value, deriv] = self.unit_value_and_deriv(q);
+    const auto grad_q =
+        is_tiny(x_norm) ? Vec<Num, Dim>{} : x * (h_inverse / x_norm);
+    return {w * value, w * deriv * grad_q};
+  }
+
   /// Width derivative of the smoothing kernel at point.
   template<class Num, std::size_t Dim, class Self>
   constexpr auto width_deriv(this Self& self,
@@ -248,10 +283,36 @@ public:
   template<class Num>
   static constexpr auto unit_deriv(Num q) noexcept -> Num;
 
+  /// Value and derivative of the unit smoothing kernel at a point.
+  template<class Num>
+  static constexpr auto unit_value_and_deriv(Num q) noexcept
+      -> std::pair<Num, Num>;
+
   /// Tail moment of the unit smoothing kernel.
   template<std::size_t Dim, class Num>
   static constexpr auto unit_antideriv_moment(Num q) noexcept -> Num;
 
+  /// Values of the unit smoothing kernel at a register of points.
+  template<class Num, std::size_t Size>
+  static auto unit_value(const simd::Reg<Num, Size>& q) noexcept
+      -> simd::Reg<Num, Size>;
+
+  /// Derivatives of the unit smoothing kernel at a register of points.
+  template<class Num, std::size_t Size>
+  static auto unit_deriv(const simd::Reg<Num, Size>& q) noexcept
+      -> simd::Reg<Num, Size>;
+
+  /// Values and derivatives of the unit smoothing kernel at a register of
+  /// points.
+  template<class Num, std::size_t Size>
+  static auto unit_value_and_deriv(const simd::Reg<Num, Size>& q) noexcept
+      -> std::pair<simd::Reg<Num, Size>, simd::Reg<Num, Size>>;
+
+  /// Tail moments of the unit smoothing kernel at a register of points.
+  template<std::size_t Dim, class Num, std::size_t Size>
+  static auto unit_antideriv_moment(const simd::Reg<Num, Size>& q) noexcept
+      -> simd::Reg<Num, Size>;
+
   /// Scalar kernel flux over a segment.
   template<class Num>
   static constexpr auto unit_flux(Num eta, Num z_min, Num z_max) noexcept
@@ -455,14 +516,145 @@ using EighthOrderWendlandKernel = KernelGen<impl::EighthOrderWendlandTag>;
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/// Generated smoothing kernel type.
+template<class K>
+concept generated_kernel = std::same_as<K, CubicSplineKernel> ||
+                           std::same_as<K, QuarticSplineKernel> ||
+                           std::same_as<K, QuinticSplineKernel> ||
+                           std::same_as<K, QuarticWendlandKernel> ||
+                           std::same_as<K, SixthOrderWendlandKernel> ||
+                           std::same_as<K, EighthOrderWendlandKernel>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Tabulated kernel.
+//
+
+/// Interpolation method of the tabulated kernel.
+enum class KernelTableInterp : std::uint8_t {
+  linear, ///< Linear interpolation.
+  cubic,  ///< Cubic (Catmull-Rom) interpolation.
+};
+
+/// Smoothing kernel whose value and derivative are interpolated from
+/// a uniform table in `q^2`.
+///
+/// Trades accuracy for speed: interpolation replaces the piecewise
+/// polynomial evaluation. Derivative is tabulated as `w'(q) / q`, which is
+/// smooth in `q^2`. Fluxes are evaluated exactly by the base kernel.
+template<generated_kernel Base,
+         class Num = double,
+         KernelTableInterp Interp = KernelTableInterp::linear>
+class TabulatedKernel final : public Kernel {
+public:
+
+  /// Construct the tabulated kernel.
+  ///
+  /// @param num_intervals Number of the table intervals.
+  explicit TabulatedKernel(std::size_t num_intervals = 4096)
+      : num_intervals_{num_intervals} {
+    TIT_ASSERT(num_intervals_ > 0, "Number of intervals must be positive!");
+    constexpr auto radius = Base::template unit_radius<Num>();
+    const auto step = pow2(radius) / static_cast<Num>(num_intervals_);
+    inv_step_ = inverse(step);
+
+    // Table has one ghost node before the support, and two after it.
+    values_.resize(num_intervals_ + 4);
+    derivs_.resize(num_intervals_ + 4);
+    for (std::size_t i = 0; i <= num_intervals_; ++i) {
+      const auto q_sqr = static_cast<Num>(i) * step;
+      const auto q = i == 0 ? sqrt(step) * Num{1.0e-4} : sqrt(q_sqr);
+      const auto [value, deriv] = Base::unit_value_and_deriv(q);
+      values_[i + 1] = i == 0 ? Base::unit_value(Num{0}) : value;
+      derivs_[i + 1] = deriv / q;
+    }
+    values_[0] = 2 * values_[1] - values_[2];
+    derivs_[0] = 2 * derivs_[1] - derivs_[2];
+  }
+
+  /// Unit support radius.
+  template<class N>
+  static consteval auto unit_radius() noexcept -> N {
+    return Base::template unit_radius<N>();
+  }
+
+  /// Value of the unit smoothing kernel at a point.
+  template<class N>
+  constexpr auto unit_value(N q) const noexcept -> N {
+    return static_cast<N>(lookup_(values_, static_cast<Num>(q)));
+  }
+
+  /// Derivative of the unit smoothing kernel at a point.
+  template<class N>
+  constexpr auto unit_deriv(N q) const noexcept -> N {
+    return q * static_cast<N>(lookup_(derivs_, static_cast<Num>(q)));
+  }
+
+  /// Value and derivative of the unit smoothing kernel at a point.
+  template<class N>
+  constexpr auto unit_value_and_deriv(N q) const noexcept
+      -> std::pair<N, N> {
+    return {unit_value(q), unit_deriv(q)};
+  }
+
+  /// Tail moment of the unit smoothing kernel.
+  template<std::size_t Dim, class N>
+  static constexpr auto unit_antideriv_moment(N q) noexcept -> N {
+    return Base::template unit_antideriv_moment<Dim>(q);
+  }
+
+  /// Scalar kernel flux over a segment or a triangle.
+  static constexpr auto unit_flux(const auto&... args) noexcept {
+    return Base::unit_flux(args...);
+  }
+
+  /// Scalar antigradient flux over a segment or a triangle.
+  static constexpr auto unit_antigrad_flux(const auto&... args) noexcept {
+    return Base::unit_antigrad_flux(args...);
+  }
+
+private:
+
+  constexpr auto lookup_(const std::vector<Num>& table, Num q) const noexcept
+      -> Num {
+    const auto s = pow2(q) * inv_step_;
+    if (s >= static_cast<Num>(num_intervals_)) return Num{0};
+    const auto i = static_cast<std::size_t>(s) + 1;
+    const auto t = s - static_cast<Num>(i - 1);
+    if constexpr (Interp == KernelTableInterp::linear) {
+      return table[i] + t * (table[i + 1] - table[i]);
+    } else {
+      const auto p0 = table[i - 1];
+      const auto p1 = table[i];
+      const auto p2 = table[i + 1];
+      const auto p3 = table[i + 2];
+      return p1 + t * (p2 - p0 +
+                       t * (2 * p0 - 5 * p1 + 4 * p2 - p3 +
+                            t * (3 * (p1 - p2) + p3 - p0))) /
+                      2;
+    }
+  }
+
+  std::size_t num_intervals_;
+  Num inv_step_{};
+  std::vector<Num> values_;
+  std::vector<Num> derivs_;
+
+}; // class TabulatedKernel
+
+namespace impl {
+template<class K>
+inline constexpr bool is_tabulated_kernel_v = false;
+template<class Base, class Num, KernelTableInterp Interp>
+inline constexpr bool
+    is_tabulated_kernel_v<TabulatedKernel<Base, Num, Interp>> = true;
+} // namespace impl
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 /// Smoothing kernel type.
 template<class K>
-concept kernel = std::same_as<K, CubicSplineKernel> ||
-                 std::same_as<K, QuarticSplineKernel> ||
-                 std::same_as<K, QuinticSplineKernel> ||
-                 std::same_as<K, QuarticWendlandKernel> ||
-                 std::same_as<K, SixthOrderWendlandKernel> ||
-                 std::same_as<K, EighthOrderWendlandKernel>;
+concept kernel = generated_kernel<K> || impl::is_tabulated_kernel_v<K>;
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
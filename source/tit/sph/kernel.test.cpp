@@ -3,9 +3,12 @@
  * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
 \* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <array>
+#include <cstddef>
 #include <numbers>
 
 #include "tit/core/math.hpp"
+#include "tit/core/simd.hpp"
 #include "tit/core/utils.hpp"
 #include "tit/core/vec.hpp"
 #include "tit/geom/bbox.hpp"
@@ -123,6 +126,82 @@ TEST_CASE_TEMPLATE("sph::Kernel::grad", Kernel, KERNEL_TYPES) {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+TEST_CASE_TEMPLATE("sph::Kernel::eval", Kernel, KERNEL_TYPES) {
+  // Ensure that the fused evaluation matches the separate value and
+  // gradient evaluations, including the origin and outside the support.
+  const Kernel w{};
+  for (const auto h : {1.0, 0.1, 0.01}) {
+    CAPTURE(h);
+    for (const auto x : {Vec{0.0, 0.0, 0.0},
+                         pow2(h) * Vec{0.1, 0.1, 0.1},
+                         h * Vec{0.5, -0.3, 0.2},
+                         h * Vec{1.5, 0.0, 0.0},
+                         h * Vec{5.0, 0.0, 0.0}}) {
+      CAPTURE(x);
+      const auto [value, gradient] = w.eval(x, h);
+      CHECK_APPROX_EQ(value, w(x, h));
+      CHECK_APPROX_EQ(gradient, w.grad(x, h));
+    }
+  }
+}
+
+TEST_CASE_TEMPLATE("sph::TabulatedKernel", Kernel, KERNEL_TYPES) {
+  // Ensure that the tabulated kernel approximates the exact one.
+  const Kernel w{};
+  const sph::TabulatedKernel<Kernel> w_linear{};
+  const sph::TabulatedKernel<Kernel, double, sph::KernelTableInterp::cubic>
+      w_cubic{};
+  const auto h = 0.1;
+  const auto w_max = w(Vec{0.0, 0.0}, h);
+  const auto grad_max = norm(w.grad(Vec{h, 0.0}, h));
+  for (std::size_t i = 0; i <= 100; ++i) {
+    const auto x = Vec{w.radius(h) * static_cast<double>(i) / 95.0, 0.0};
+    CAPTURE(x);
+    CHECK(abs(w_linear(x, h) - w(x, h)) <= 1.0e-4 * w_max);
+    CHECK(abs(w_cubic(x, h) - w(x, h)) <= 1.0e-4 * w_max);
+    CHECK(norm(w_linear.grad(x, h) - w.grad(x, h)) <= 1.0e-3 * grad_max);
+    CHECK(norm(w_cubic.grad(x, h) - w.grad(x, h)) <= 1.0e-3 * grad_max);
+  }
+}
+
+TEST_CASE_TEMPLATE("sph::KernelGen::unit_value(simd)", Kernel, KERNEL_TYPES) {
+  // Ensure that the SIMD overloads match the scalar ones in each lane,
+  // including the interval boundaries and outside the support.
+  constexpr auto Size = simd::min_reg_size_v<double>;
+  using Reg = simd::Reg<double, Size>;
+  const auto radius = Kernel::template unit_radius<double>();
+  std::array<double, Size> q{};
+  std::array<double, Size> value{};
+  std::array<double, Size> deriv{};
+  std::array<double, Size> moment{};
+  for (std::size_t i = 0; i <= 64; i += Size) {
+    for (std::size_t j = 0; j < Size; ++j) {
+      q[j] = (radius + 0.5) * static_cast<double>(i + j) / 64.0;
+    }
+    const Reg q_reg{q};
+    Kernel::unit_value(q_reg).store(value);
+    Kernel::unit_deriv(q_reg).store(deriv);
+    Kernel::template unit_antideriv_moment<2>(q_reg).store(moment);
+    for (std::size_t j = 0; j < Size; ++j) {
+      CAPTURE(q[j]);
+      CHECK_APPROX_EQ(value[j], Kernel::unit_value(q[j]));
+      CHECK_APPROX_EQ(deriv[j], Kernel::unit_deriv(q[j]));
+      CHECK_APPROX_EQ(moment[j],
+                      Kernel::template unit_antideriv_moment<2>(q[j]));
+    }
+    const auto [value_reg, deriv_reg] = Kernel::unit_value_and_deriv(q_reg);
+    value_reg.store(value);
+    deriv_reg.store(deriv);
+    for (std::size_t j = 0; j < Size; ++j) {
+      CAPTURE(q[j]);
+      CHECK_APPROX_EQ(value[j], Kernel::unit_value(q[j]));
+      CHECK_APPROX_EQ(deriv[j], Kernel::unit_deriv(q[j]));
+    }
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 TEST_CASE_TEMPLATE("sph::Kernel::width_deriv", Kernel, KERNEL_TYPES) {
   // Ensure that the kernel width derivative is computed correctly:
   // calculate the derivative of the kernel value using dual numbers
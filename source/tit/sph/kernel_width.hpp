@@ -0,0 +1,96 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <concepts>
+
+#include "tit/core/assert.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/type.hpp"
+#include "tit/par/algorithms.hpp"
+#include "tit/par/atomic.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/particle_array.hpp"
+
+namespace tit::sph {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Fixed kernel width.
+///
+/// Kernel width is an array-wise constant.
+class FixedKernelWidth final {
+public:
+
+  /// Set of particle fields that are required.
+  static constexpr TypeSet required_fields{h};
+
+  /// Set of particle fields that are modified.
+  static constexpr TypeSet modified_fields{/*empty*/};
+
+  /// Update the kernel width.
+  template<particle_array<required_fields> ParticleArray>
+  constexpr void update(ParticleArray& /*particles*/) const noexcept {}
+
+}; // class FixedKernelWidth
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Adaptive kernel width.
+///
+/// Kernel width of each fluid particle is proportional to the particle
+/// spacing estimated from its volume: `h = eta * (m / rho)^(1/d)`. Widths of
+/// the fixed particles are left unchanged.
+template<class Num>
+class AdaptiveKernelWidth final {
+public:
+
+  /// Set of particle fields that are required.
+  static constexpr TypeSet required_fields{h, m, rho};
+
+  /// Set of particle fields that are modified.
+  static constexpr TypeSet modified_fields{h};
+
+  /// Construct an adaptive kernel width.
+  ///
+  /// @param eta Ratio of the kernel width to the particle spacing.
+  constexpr explicit AdaptiveKernelWidth(Num eta) noexcept : eta_{eta} {
+    TIT_ASSERT(eta_ > Num{0}, "Width to spacing ratio must be positive!");
+  }
+
+  /// Update the kernel width from the particle density.
+  template<particle_array<required_fields> ParticleArray>
+  void update(ParticleArray& particles) const {
+    using PV = ParticleView<ParticleArray>;
+    constexpr auto inv_dim = inverse(static_cast<Num>(particle_dim_v<PV>));
+    bool changed = false;
+    par::for_each(particles.fluid(), [&changed, this](PV a) {
+      const auto new_h = eta_ * pow(m[a] / rho[a], inv_dim);
+      if (bitwise_equal(h[a], new_h)) return;
+      h[a] = new_h;
+      par::store(changed, true);
+    });
+
+    // Positions are unchanged, but the widths may have changed.
+    if (changed) particles.touch(0.0);
+  }
+
+private:
+
+  Num eta_;
+
+}; // class AdaptiveKernelWidth
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Kernel width type.
+template<class KW, class Num>
+concept kernel_width = std::same_as<KW, FixedKernelWidth> ||
+                       std::same_as<KW, AdaptiveKernelWidth<Num>>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::sph
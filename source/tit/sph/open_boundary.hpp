@@ -0,0 +1,193 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <vector>
+
+#include "tit/core/assert.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/profiler.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/par/algorithms.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/particle_array.hpp"
+
+namespace tit::sph {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Open boundary with the inflow and outflow buffer zones.
+///
+/// Each buffer zone is a slab of the specified depth, adjacent to the inflow
+/// or outflow plane from the outside of the domain. Depth of the buffer zones
+/// must be at least the kernel radius.
+///
+/// Fluid particles in the inflow zone form a conveyor: their velocity and
+/// density are prescribed, and once a particle crosses the inflow plane into
+/// the domain, a new particle is spawned one buffer depth behind it. Fluid
+/// particles that leave the outflow zone are recycled into the spawned
+/// particles. Recycled particles that are not needed yet are parked (see
+/// `ParticleArray::park`): they keep their slots, but are excluded from the
+/// simulation and the output, and are reused by the later spawns. New
+/// particles are appended only when there are no parked particles left, so
+/// in a steady flow the particle count stays constant, and the particle
+/// arrays are never shifted.
+template<class Num, std::size_t Dim>
+class OpenBoundary final {
+public:
+
+  /// Construct the open boundary.
+  ///
+  /// @param inlet_origin  Point on the inflow plane.
+  /// @param inlet_normal  Inflow plane normal, pointing into the domain.
+  /// @param outlet_origin Point on the outflow plane.
+  /// @param outlet_normal Outflow plane normal, pointing into the domain.
+  /// @param depth         Depth of the buffer zones.
+  /// @param v_in          Inflow velocity magnitude.
+  /// @param rho_in        Inflow density.
+  constexpr OpenBoundary(const Vec<Num, Dim>& inlet_origin,
+                         const Vec<Num, Dim>& inlet_normal,
+                         const Vec<Num, Dim>& outlet_origin,
+                         const Vec<Num, Dim>& outlet_normal,
+                         Num depth,
+                         Num v_in,
+                         Num rho_in)
+      : inlet_origin_{inlet_origin}, inlet_normal_{normalize(inlet_normal)},
+        outlet_origin_{outlet_origin},
+        outlet_normal_{normalize(outlet_normal)}, //
+        depth_{depth}, v_in_{v_in}, rho_in_{rho_in} {
+    TIT_ASSERT(depth_ > Num{0}, "Buffer depth must be positive!");
+    TIT_ASSERT(v_in_ >= Num{0}, "Inflow velocity must be non-negative!");
+    TIT_ASSERT(rho_in_ > Num{0}, "Inflow density must be positive!");
+  }
+
+  /// Spawn, recycle and park the particles, and impose the inflow state.
+  ///
+  /// Should be called after each time step.
+  template<particle_array<r, v, rho> ParticleArray>
+    requires (!has_uniform<ParticleArray>(r) &&
+              !has_uniform<ParticleArray>(v) &&
+              !has_uniform<ParticleArray>(rho))
+  void update(ParticleArray& particles) {
+    TIT_PROFILE_SECTION("OpenBoundary::update()");
+    using PV = ParticleView<ParticleArray>;
+
+    // States are tracked only for the fluid particles, which are stored
+    // first, so the fluid indices are stable.
+    state_.resize(particles.size(), State_::none);
+
+    // Classify the fluid particles.
+    par::for_each(particles.fluid(), [this](PV a) {
+      auto& state = state_[a.index()];
+      const auto inlet_dist = dot(r[a] - inlet_origin_, inlet_normal_);
+      const auto outlet_dist = dot(r[a] - outlet_origin_, outlet_normal_);
+      if (inlet_dist < Num{0} && inlet_dist >= -depth_) {
+        state = State_::inlet;
+      } else if (outlet_dist < -depth_) {
+        state = State_::exited;
+      } else if (state == State_::inlet && inlet_dist >= Num{0}) {
+        state = State_::entered;
+      } else {
+        state = State_::none;
+      }
+    });
+    const auto fluid_indices =
+        particles.fluid() | std::views::transform(&PV::index);
+    const auto collect = [&fluid_indices, this](State_ state) {
+      std::vector<std::size_t> result(std::ranges::size(fluid_indices));
+      result.erase(par::stable_copy_if(fluid_indices,
+                                       result.begin(),
+                                       [state, this](std::size_t a) {
+                                         return state_[a] == state;
+                                       }),
+                   result.end());
+      return result;
+    };
+    const auto entered = collect(State_::entered);
+    auto slots = collect(State_::exited);
+    if (entered.empty() && slots.empty()) {
+      impose_inflow_(particles);
+      return;
+    }
+
+    // Gather the free slots: exited particles first, then the parked ones.
+    // Append the missing slots.
+    while (slots.size() < entered.size() && particles.num_parked() > 0) {
+      slots.push_back(particles.unpark().index());
+    }
+    if (slots.size() < entered.size()) {
+      const auto num_missing = entered.size() - slots.size();
+      const auto appended =
+          particles.append_n(ParticleType::fluid, num_missing);
+      slots.append_range(appended | std::views::transform(&PV::index));
+      state_.resize(particles.size(), State_::none);
+    }
+
+    // Spawn the particles one buffer depth behind the entered ones.
+    par::for_each(std::views::zip(slots, entered), [&particles, this](auto sp) {
+      const auto [slot, parent] = sp;
+      particles.assign(slot, parent);
+      r[particles[slot]] -= depth_ * inlet_normal_;
+      state_[slot] = State_::inlet;
+      state_[parent] = State_::none;
+    });
+
+    // Park the remaining exited particles. Parking moves the last fluid
+    // particle into the parked slot, so the slots are parked from the last
+    // one, and the states are moved along with the particles.
+    auto unused = std::views::drop(slots, entered.size());
+    std::ranges::sort(unused, std::greater{});
+    for (const auto slot : unused) {
+      const auto moved = particles.park(slot);
+      state_[slot] = state_[moved];
+      state_[moved] = State_::none;
+    }
+
+    // Impose the inflow state. Recycled and parked slots now hold the
+    // different particles.
+    impose_inflow_(particles);
+    particles.relayout();
+  }
+
+private:
+
+  template<class ParticleArray>
+  void impose_inflow_(ParticleArray& particles) const {
+    using PV = ParticleView<ParticleArray>;
+    par::for_each(particles.fluid(), [this](PV a) {
+      if (state_[a.index()] == State_::inlet) {
+        v[a] = v_in_ * inlet_normal_;
+        rho[a] = rho_in_;
+      }
+    });
+  }
+
+  enum class State_ : std::uint8_t {
+    none,
+    inlet,
+    entered,
+    exited,
+  };
+
+  Vec<Num, Dim> inlet_origin_;
+  Vec<Num, Dim> inlet_normal_;
+  Vec<Num, Dim> outlet_origin_;
+  Vec<Num, Dim> outlet_normal_;
+  Num depth_;
+  Num v_in_;
+  Num rho_in_;
+  std::vector<State_> state_;
+
+}; // class OpenBoundary
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::sph
@@ -5,10 +5,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <tuple>
@@ -18,9 +20,12 @@
 
 #include "tit/core/assert.hpp"
 #include "tit/core/float.hpp"
+#include "tit/core/math.hpp"
 #include "tit/core/type.hpp"
 #include "tit/core/vec.hpp"
 #include "tit/data/storage.hpp"
+#include "tit/par/algorithms.hpp"
+#include "tit/par/memory.hpp"
 #include "tit/sph/field.hpp"
 
 namespace tit::sph {
@@ -29,8 +34,9 @@ namespace tit::sph {
 
 /// Particle type.
 enum class ParticleType : std::uint8_t {
-  fluid, ///< Fluid particle.
-  fixed, ///< Fixed (boundary) particle.
+  fluid,  ///< Fluid particle.
+  parked, ///< Parked particle, that keeps its slot, but is not simulated.
+  fixed,  ///< Fixed (boundary) particle.
   count, ///< Number of particle types.
 };
 
@@ -88,6 +94,11 @@ public:
     return has_type(ParticleType::fixed);
   }
 
+  /// Check if the particle is parked.
+  constexpr auto is_parked() const noexcept -> bool {
+    return has_type(ParticleType::parked);
+  }
+
   /// Particle field value.
   template<class Self, field Field>
   constexpr auto operator[](this Self&& self, Field field) noexcept
@@ -151,6 +162,19 @@ public:
   /// Set of particle fields that are present.
   static constexpr field_set auto fields = uniform_fields | varying_fields;
 
+  /// Subset of varying particle fields that are backed by the scratch
+  /// storage, see `scratch`.
+  static constexpr field_set auto transient_fields =
+      transient_subset(varying_fields);
+
+  /// Subset of varying particle fields that are stored permanently.
+  static constexpr field_set auto persistent_fields =
+      varying_fields - transient_fields;
+
+  /// Subset of persistent particle fields that are written into the output.
+  static constexpr field_set auto output_fields =
+      output_subset(persistent_fields);
+
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   /// Construct a particle array.
@@ -161,13 +185,22 @@ public:
   constexpr explicit ParticleArray(Space /*space*/,
                                    Equations /*equations*/) noexcept {}
 
-  /// Write a particle array into a series.
+  /// Write a particle array into a series. Only the output fields are
+  /// written, transient fields, non-output fields and parked particles are
+  /// not.
   void write(field_value_t<h_t, Space> time,
              data::SeriesView<data::Storage> series) const {
     auto frame = series.create_frame(static_cast<float64_t>(time));
-    ParticleArray::varying_fields.for_each([&frame, this](auto field) {
+    ParticleArray::output_fields.for_each([&frame, this](auto field) {
       const auto array = frame.create_array(field.field_name);
-      array.write(field[*this]);
+      if (num_parked() == 0) {
+        array.write(field[*this]);
+        return;
+      }
+      const std::vector values(
+          std::from_range,
+          all() | std::views::transform([field](auto a) { return field[a]; }));
+      array.write(values);
     });
   }
 
@@ -178,33 +211,307 @@ public:
     return std::get<0>(varying_data_).size();
   }
 
+  /// Generation of the particle positions.
+  ///
+  /// Generation is incremented each time the positions or the set of the
+  /// particles change, so that the state derived from the positions may be
+  /// reused while the generation stays the same.
+  constexpr auto generation() const noexcept -> std::size_t {
+    return generation_;
+  }
+
+  /// Generation of the last modification with an unknown displacement bound.
+  constexpr auto drift_origin() const noexcept -> std::size_t {
+    return drift_origin_;
+  }
+
+  /// Upper bound of the particle displacement accumulated since the drift
+  /// origin generation.
+  constexpr auto drift() const noexcept -> float64_t {
+    return drift_;
+  }
+
+  /// Mark the particle positions as modified.
+  ///
+  /// Code that modifies the positions must call this function before the
+  /// state derived from the positions is refreshed.
+  ///
+  /// @param max_displacement Upper bound of the particle displacements since
+  ///                         the previous generation, if known.
+  constexpr void touch(std::optional<float64_t> max_displacement = {}) {
+    generation_ += 1;
+    if (max_displacement.has_value()) {
+      TIT_ASSERT(*max_displacement >= 0.0,
+                 "Displacement bound must be non-negative!");
+      drift_ += *max_displacement;
+    } else {
+      drift_origin_ = generation_;
+      drift_ = 0.0;
+    }
+  }
+
+  /// Generation of the particle layout.
+  ///
+  /// Layout generation is incremented each time the particles are added,
+  /// removed, reordered, or their slots are reused for the other particles,
+  /// so that the state associated with the particle indices may be reused
+  /// while the layout generation stays the same.
+  constexpr auto layout_generation() const noexcept -> std::size_t {
+    return layout_generation_;
+  }
+
+  /// Mark the particle layout as modified. Positions are touched as well.
+  constexpr void relayout() {
+    layout_generation_ += 1;
+    touch();
+  }
+
   /// Reserve amount of particles.
-  constexpr void reserve(std::size_t capacity) {
+  void reserve(std::size_t capacity) {
     auto& [... cols] = varying_data_;
-    ((cols.reserve(capacity)), ...);
+    ((capacity > cols.capacity() ? relocate_(cols, capacity) : void()), ...);
   }
 
   /// Appends a new particle of the specified type @p type.
   constexpr auto append(ParticleType type) -> ParticleView<ParticleArray> {
+    return append_n(type, 1).front();
+  }
+
+  /// Appends @p count new particles of the specified type @p type.
+  ///
+  /// @returns Range of the appended particles.
+  auto append_n(ParticleType type, std::size_t count) {
     TIT_ASSERT(type < ParticleType::count, "Invalid particle type.");
+    TIT_ASSERT(type != ParticleType::parked, "Cannot append parked particles.");
     const auto type_index = std::to_underlying(type);
     // Get the index of the next particle of the specified type and increment
     // the range of particles for the next types.
     const std::size_t index = particle_ranges_[type_index + 1];
-    for (auto& p : particle_ranges_ | std::views::drop(type_index + 1)) p += 1;
-    // Insert the new particle.
+    TIT_ASSERT(!scratch_active_, "Particles are modified inside a scratch!");
+    relayout();
+    for (auto& p : particle_ranges_ | std::views::drop(type_index + 1)) {
+      p += count;
+    }
+    // Insert the new particles. Columns are grown in advance, so that the
+    // vectors do not reallocate themselves.
+    auto& [... cols] = varying_data_;
+    (
+        [&col = cols, index, count] {
+          if (const auto size = col.size() + count; size > col.capacity()) {
+            relocate_(col, std::max(size, 2 * col.capacity()));
+          }
+          col.insert(col.begin() + index,
+                     count,
+                     std::ranges::range_value_t<decltype(col)>{});
+        }(),
+        ...);
+    return std::views::iota(index, index + count) |
+           std::views::transform(
+               [this](std::size_t i) { return (*this)[i]; });
+  }
+
+  /// Copy the field values of the particle at @p src_index into the particle
+  /// at @p dst_index.
+  ///
+  /// This function may be called concurrently for the different destination
+  /// particles. It does not modify the layout, so the caller must call
+  /// `relayout()` once all the particles are assigned.
+  constexpr void assign(std::size_t dst_index, std::size_t src_index) {
+    TIT_ASSERT(dst_index < size(), "Particle index is out of range.");
+    TIT_ASSERT(src_index < size(), "Particle index is out of range.");
+    auto& [... cols] = varying_data_;
+    ((cols[dst_index] = cols[src_index]), ...);
+  }
+
+  /// Number of the parked particles.
+  constexpr auto num_parked() const noexcept -> std::size_t {
+    const auto type_index = std::to_underlying(ParticleType::parked);
+    return particle_ranges_[type_index + 1] - particle_ranges_[type_index];
+  }
+
+  /// Park the fluid particle at @p index.
+  ///
+  /// Parked particle keeps its slot, so that the slot can be reused later
+  /// without shifting the particle arrays, but it is excluded from all the
+  /// particle ranges and is not written. Last fluid particle is moved into
+  /// the slot of the parked one, and the fixed particles are never moved.
+  /// The caller must call `relayout()` once all the particles are parked.
+  ///
+  /// @returns Former index of the fluid particle that was moved into the
+  ///          slot, which is @p index if no particle was moved.
+  constexpr auto park(std::size_t index) -> std::size_t {
+    TIT_ASSERT(has_type(index, ParticleType::fluid),
+               "Only fluid particles can be parked!");
+    TIT_ASSERT(!scratch_active_, "Particles are modified inside a scratch!");
+    auto& fluid_end =
+        particle_ranges_[std::to_underlying(ParticleType::parked)];
+    fluid_end -= 1;
+    if (index != fluid_end) assign(index, fluid_end);
+    return fluid_end;
+  }
+
+  /// Turn the first parked particle back into a fluid one.
+  ///
+  /// Field values of the particle are left from the particle that was
+  /// parked, and should be assigned by the caller. The caller must call
+  /// `relayout()` once all the particles are unparked.
+  constexpr auto unpark() -> ParticleView<ParticleArray> {
+    TIT_ASSERT(num_parked() > 0, "No parked particles!");
+    TIT_ASSERT(!scratch_active_, "Particles are modified inside a scratch!");
+    auto& fluid_end =
+        particle_ranges_[std::to_underlying(ParticleType::parked)];
+    return (*this)[fluid_end++];
+  }
+
+  /// Remove the particles that satisfy the predicate @p pred.
+  ///
+  /// Remaining particles are compacted, their relative order is preserved.
+  ///
+  /// @returns Number of the removed particles.
+  template<std::predicate<ParticleView<ParticleArray>> Pred>
+  auto erase_if(Pred pred) -> std::size_t {
+    // Collect the indices of the remaining particles.
+    const auto old_size = size();
+    std::vector<std::size_t> kept(old_size);
+    kept.erase(par::stable_copy_if(
+                   std::views::iota(std::size_t{0}, old_size),
+                   kept.begin(),
+                   [&pred, this](std::size_t i) { return !pred((*this)[i]); }),
+               kept.end());
+    if (kept.size() == old_size) return 0;
+    TIT_ASSERT(!scratch_active_, "Particles are modified inside a scratch!");
+    relayout();
+
+    // Shrink the ranges of particles of each type.
+    for (auto& p : particle_ranges_) {
+      p = static_cast<std::size_t>(std::ranges::lower_bound(kept, p) -
+                                   kept.begin());
+    }
+
+    // Gather the values of the remaining particles.
     auto& [... cols] = varying_data_;
-    ((cols.emplace(cols.begin() + index)), ...);
-    return (*this)[index];
+    (
+        [&kept, &col = cols] {
+          std::remove_reference_t<decltype(col)> new_col{};
+          par::resize_for_overwrite(new_col, kept.size());
+          par::numa_for_each(std::views::zip(kept, new_col), [&col](auto pair) {
+            auto&& [index, new_val] = pair;
+            new_val = std::move(col[index]);
+          });
+          col = std::move(new_col);
+        }(),
+        ...);
+
+    return old_size - kept.size();
+  }
+
+  /// Reallocate the particle data, such that the memory pages are first
+  /// touched in parallel by the worker threads. If the threads are pinned to
+  /// the NUMA nodes, pages are spread across the nodes in contiguous chunks
+  /// of the particle indices.
+  void first_touch() {
+    auto& [... cols] = varying_data_;
+    ((relocate_(cols, cols.capacity())), ...);
+  }
+
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  /// Scratch storage scope.
+  ///
+  /// Transient fields are detached from the scratch storage when the scope
+  /// is destroyed.
+  template<class... Fields>
+  class ScratchScope final {
+  public:
+
+    /// Construct the scratch scope.
+    constexpr explicit ScratchScope(ParticleArray& particles) noexcept
+        : particles_{&particles} {}
+
+    /// Detach the transient fields from the scratch storage.
+    constexpr ~ScratchScope() noexcept {
+      if (particles_ == nullptr) return;
+      ((std::get<transient_fields.find(Fields{})>(particles_->scratch_data_) =
+            {}),
+       ...);
+      particles_->scratch_active_ = false;
+    }
+
+    /// Move-construct the scratch scope.
+    constexpr ScratchScope(ScratchScope&& other) noexcept
+        : particles_{std::exchange(other.particles_, nullptr)} {}
+
+    /// This class is not move-assignable.
+    constexpr auto operator=(ScratchScope&&) -> ScratchScope& = delete;
+
+    /// This class is not copy-constructible.
+    constexpr ScratchScope(const ScratchScope&) = delete;
+
+    /// This class is not copy-assignable.
+    constexpr auto operator=(const ScratchScope&) -> ScratchScope& = delete;
+
+  private:
+
+    ParticleArray* particles_;
+
+  }; // class ScratchScope
+
+  /// Back the transient fields with the scratch storage.
+  ///
+  /// Transient fields are accessible only while the returned scope is alive.
+  /// Scratch storage is shared by all the scopes, so that the transient
+  /// fields of the different phases occupy the same memory. Scopes may not
+  /// be nested, and the particles may not be added or removed while a scope
+  /// is alive. Values of the transient fields are not preserved between the
+  /// scopes.
+  template<transient_field... Fields>
+  [[nodiscard]] auto scratch(TypeSet<Fields...> /*fields*/)
+      -> ScratchScope<Fields...> {
+    static_assert((transient_fields.contains(Fields{}) && ...));
+    TIT_ASSERT(!scratch_active_, "Scratch scopes may not be nested!");
+    scratch_active_ = true;
+
+    // Columns are aligned to the scratch blocks. Old values are discarded
+    // when the storage grows, so nothing is copied.
+    const auto num_blocks = [this]<class Field>(Field /*field*/) {
+      using Val = field_value_t<Field, Space>;
+      return divide_up(size() * sizeof(Val), sizeof(ScratchBlock_));
+    };
+    if (const auto total = (std::size_t{0} + ... + num_blocks(Fields{}));
+        scratch_.size() < total) {
+      scratch_.clear();
+      par::resize_for_overwrite(scratch_, total);
+    }
+
+    // Attach the transient fields to the scratch storage.
+    auto* const bytes = safe_bit_ptr_cast<std::byte*>(scratch_.data());
+    std::size_t offset = 0;
+    (
+        [&num_blocks, bytes, &offset, this] {
+          using Val = field_value_t<Fields, Space>;
+          std::get<transient_fields.find(Fields{})>(scratch_data_) =
+              std::span{safe_bit_ptr_cast<Val*>(bytes + offset), size()};
+          offset += num_blocks(Fields{}) * sizeof(ScratchBlock_);
+        }(),
+        ...);
+
+    return ScratchScope<Fields...>{*this};
   }
 
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  /// All particles.
+  /// All particles, except the parked ones.
   constexpr auto all(this auto& self) noexcept {
-    return std::views::iota(std::size_t{0}, self.size()) |
+    // Parked particles are stored between the fluid and the fixed ones.
+    const auto num_parked = self.num_parked();
+    const auto parked_begin =
+        self.particle_ranges_[std::to_underlying(ParticleType::parked)];
+    return std::views::iota(std::size_t{0}, self.size() - num_parked) |
            std::views::transform(
-               [&self](std::size_t index) { return self[index]; });
+               [&self, num_parked, parked_begin](std::size_t index) {
+                 return self[index < parked_begin ? index :
+                                                    index + num_parked];
+               });
   }
 
   /// Particles of the specified type.
@@ -227,6 +534,11 @@ public:
     return self.typed(ParticleType::fixed);
   }
 
+  /// Parked particles.
+  constexpr auto parked(this auto& self) noexcept {
+    return self.typed(ParticleType::parked);
+  }
+
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   /// Check if the particle has the specified type.
@@ -253,8 +565,17 @@ public:
     TIT_ASSERT(index < self.size(), "Particle index is out of range.");
     if constexpr (uniform_fields.contains(Field{})) {
       return std::get<uniform_fields.find(Field{})>(self.uniform_data_);
-    } else if constexpr (varying_fields.contains(Field{})) {
-      return std::get<varying_fields.find(Field{})>(self.varying_data_)[index];
+    } else if constexpr (transient_fields.contains(Field{})) {
+      TIT_ASSERT(self.scratch_active_, "Transient field is not in scratch!");
+      auto& col = std::get<transient_fields.find(Field{})>(self.scratch_data_);
+      if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)>>) {
+        return std::as_const(col[index]);
+      } else {
+        return col[index];
+      }
+    } else if constexpr (persistent_fields.contains(Field{})) {
+      return std::get<persistent_fields.find(Field{})>(
+          self.varying_data_)[index];
     } else {
       static_assert(false);
     }
@@ -267,9 +588,18 @@ public:
     static_assert(fields.contains(Field{}));
     if constexpr (uniform_fields.contains(Field{})) {
       return std::get<uniform_fields.find(Field{})>(self.uniform_data_);
-    } else if constexpr (varying_fields.contains(Field{})) {
+    } else if constexpr (transient_fields.contains(Field{})) {
+      TIT_ASSERT(self.scratch_active_, "Transient field is not in scratch!");
+      const auto col =
+          std::get<transient_fields.find(Field{})>(self.scratch_data_);
+      if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)>>) {
+        return std::span<const typename decltype(col)::value_type>{col};
+      } else {
+        return col;
+      }
+    } else if constexpr (persistent_fields.contains(Field{})) {
       return std::span{
-          std::get<varying_fields.find(Field{})>(self.varying_data_)};
+          std::get<persistent_fields.find(Field{})>(self.varying_data_)};
     } else {
       static_assert(false);
     }
@@ -281,14 +611,46 @@ private:
 
   std::array<std::size_t, std::to_underlying(ParticleType::count) + 1>
       particle_ranges_{0};
+  std::size_t layout_generation_ = 0;
+  std::size_t generation_ = 0;
+  std::size_t drift_origin_ = 0;
+  float64_t drift_ = 0.0;
 
   [[no_unique_address]] decltype([]<class... Fields>(TypeSet<Fields...> /*f*/) {
     return std::tuple<field_value_t<Fields, Space>...>{};
   }(uniform_fields)) uniform_data_;
 
   [[no_unique_address]] decltype([]<class... Fields>(TypeSet<Fields...> /*f*/) {
-    return std::tuple<std::vector<field_value_t<Fields, Space>>...>{};
-  }(varying_fields)) varying_data_;
+    return std::tuple<std::vector<field_value_t<Fields, Space>,
+                                  par::FirstTouchAllocator<
+                                      field_value_t<Fields, Space>>>...>{};
+  }(persistent_fields)) varying_data_;
+
+  [[no_unique_address]] decltype([]<class... Fields>(TypeSet<Fields...> /*f*/) {
+    return std::tuple<std::span<field_value_t<Fields, Space>>...>{};
+  }(transient_fields)) scratch_data_;
+
+  struct alignas(64) ScratchBlock_ final {
+    std::array<std::byte, 64> bytes;
+  };
+
+  // Reallocate the column with the specified capacity. Values are moved in
+  // parallel, so that the new memory pages are first touched by the worker
+  // threads of the NUMA nodes.
+  template<class Column>
+  static void relocate_(Column& col, std::size_t capacity) {
+    Column new_col{};
+    new_col.reserve(capacity);
+    par::resize_for_overwrite(new_col, col.size());
+    par::numa_for_each(std::views::zip(col, new_col), [](auto pair) {
+      auto&& [val, new_val] = pair;
+      new_val = std::move(val);
+    });
+    col = std::move(new_col);
+  }
+
+  std::vector<ScratchBlock_, par::FirstTouchAllocator<ScratchBlock_>> scratch_;
+  bool scratch_active_ = false;
 
 }; // class ParticleArray
 
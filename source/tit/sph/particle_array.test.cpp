@@ -0,0 +1,455 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cstddef>
+#include <ranges>
+#include <tuple>
+
+#include "tit/core/type.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/bbox.hpp"
+#include "tit/geom/face_search.hpp"
+#include "tit/geom/partition.hpp"
+#include "tit/geom/search.hpp"
+#include "tit/geom/surface.hpp"
+#include "tit/par/control.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/open_boundary.hpp"
+#include "tit/sph/particle_array.hpp"
+#include "tit/sph/particle_generator.hpp"
+#include "tit/sph/particle_mesh.hpp"
+#include "tit/sph/particle_refinement.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Equations stub that defines the particle fields.
+struct Equations final {
+  static constexpr TypeSet required_fields{
+      sph::r, v, m, rho, h, dr, rho_raw, r_n};
+  static constexpr TypeSet modified_fields{
+      sph::r, v, m, rho, dr, rho_raw, r_n};
+};
+
+using ParticleArray = decltype(sph::ParticleArray{sph::Space<double, 2>{},
+                                                  Equations{}});
+using PV = sph::ParticleView<ParticleArray>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::ParticleArray::append_n") {
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  for (const PV a : particles.append_n(sph::ParticleType::fixed, 2)) {
+    m[a] = 2.0;
+  }
+  for (const PV a : particles.append_n(sph::ParticleType::fluid, 3)) {
+    m[a] = 1.0;
+  }
+  REQUIRE(particles.size() == 5);
+  CHECK(std::ranges::size(particles.fluid()) == 3);
+  CHECK(std::ranges::size(particles.fixed()) == 2);
+  for (const PV a : particles.fluid()) CHECK(m[a] == 1.0);
+  for (const PV a : particles.fixed()) CHECK(m[a] == 2.0);
+}
+
+TEST_CASE("sph::ParticleArray::erase_if") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  for (const PV a : particles.append_n(sph::ParticleType::fluid, 6)) {
+    m[a] = static_cast<double>(a.index());
+  }
+  for (const PV a : particles.append_n(sph::ParticleType::fixed, 3)) {
+    m[a] = static_cast<double>(a.index());
+  }
+
+  // Remove the particles with odd indices.
+  const auto num_removed =
+      particles.erase_if([](PV a) { return a.index() % 2 == 1; });
+  CHECK(num_removed == 4);
+  REQUIRE(particles.size() == 5);
+  CHECK(std::ranges::size(particles.fluid()) == 3);
+  CHECK(std::ranges::size(particles.fixed()) == 2);
+  CHECK(m[particles.fluid()[0]] == 0.0);
+  CHECK(m[particles.fluid()[1]] == 2.0);
+  CHECK(m[particles.fluid()[2]] == 4.0);
+  CHECK(m[particles.fixed()[0]] == 6.0);
+  CHECK(m[particles.fixed()[1]] == 8.0);
+}
+
+TEST_CASE("sph::ParticleArray::first_touch") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  for (const PV a : particles.append_n(sph::ParticleType::fluid, 100)) {
+    m[a] = static_cast<double>(a.index());
+    sph::r[a] = {1.0, 2.0};
+  }
+  SUBCASE("first touch") {
+    particles.first_touch();
+  }
+  SUBCASE("reserve") {
+    particles.reserve(1000);
+  }
+  SUBCASE("append") {
+    // Appended particles are default-initialized, even when the columns are
+    // reallocated.
+    for (const PV a : particles.append_n(sph::ParticleType::fixed, 1000)) {
+      CHECK(m[a] == 0.0);
+      CHECK(sph::r[a] == Vec<double, 2>{});
+    }
+  }
+  for (const PV a : particles.fluid()) {
+    CHECK(m[a] == static_cast<double>(a.index()));
+    CHECK(sph::r[a] == Vec<double, 2>{1.0, 2.0});
+  }
+}
+
+TEST_CASE("sph::ParticleArray::scratch") {
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  static_assert(ParticleArray::transient_fields == TypeSet{dr, rho_raw});
+  static_assert(!ParticleArray::persistent_fields.contains(rho_raw));
+  particles.append_n(sph::ParticleType::fluid, 3);
+  const void* data = nullptr;
+  {
+    const auto scratch = particles.scratch(TypeSet{rho_raw});
+    REQUIRE(rho_raw[particles].size() == 3);
+    for (const PV a : particles.all()) {
+      rho_raw[a] = static_cast<double>(a.index());
+    }
+    CHECK(rho_raw[particles[2]] == 2.0);
+    data = rho_raw[particles].data();
+  }
+  {
+    // Transient fields of the different scopes share the storage.
+    const auto scratch = particles.scratch(TypeSet{dr});
+    REQUIRE(dr[particles].size() == 3);
+    CHECK(static_cast<const void*>(dr[particles].data()) == data);
+  }
+}
+
+TEST_CASE("sph::ParticleArray::output_fields") {
+  // Integrator stage fields are stored permanently, but not written.
+  static_assert(ParticleArray::persistent_fields.contains(r_n));
+  static_assert(!ParticleArray::output_fields.contains(r_n));
+  static_assert(!ParticleArray::output_fields.contains(rho_raw));
+  static_assert(ParticleArray::output_fields.contains(sph::r));
+  static_assert(ParticleArray::output_fields.contains(rho));
+}
+
+TEST_CASE("sph::ParticleArray::touch") {
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  CHECK(particles.generation() == 0);
+  CHECK(particles.drift_origin() == 0);
+  CHECK(particles.drift() == 0.0);
+  SUBCASE("bounded") {
+    particles.touch(0.5);
+    particles.touch(0.25);
+    CHECK(particles.generation() == 2);
+    CHECK(particles.drift_origin() == 0);
+    CHECK(particles.drift() == 0.75);
+  }
+  SUBCASE("unbounded") {
+    // Structural changes move the particles by an unknown distance.
+    particles.touch(0.5);
+    particles.append_n(sph::ParticleType::fluid, 2);
+    CHECK(particles.generation() == 2);
+    CHECK(particles.drift_origin() == 2);
+    CHECK(particles.drift() == 0.0);
+  }
+}
+
+TEST_CASE("sph::ParticleArray::relayout") {
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  CHECK(particles.layout_generation() == 0);
+  SUBCASE("touch") {
+    // Moving the particles does not change the layout.
+    particles.touch();
+    CHECK(particles.layout_generation() == 0);
+  }
+  SUBCASE("append and erase") {
+    particles.append_n(sph::ParticleType::fluid, 2);
+    CHECK(particles.layout_generation() == 1);
+    particles.erase_if([](PV a) { return a.index() == 0; });
+    CHECK(particles.layout_generation() == 2);
+    particles.erase_if([](PV /*a*/) { return false; });
+    CHECK(particles.layout_generation() == 2);
+  }
+  SUBCASE("assign") {
+    particles.append_n(sph::ParticleType::fluid, 2);
+    particles.assign(0, 1);
+    particles.relayout();
+    CHECK(particles.layout_generation() == 2);
+    CHECK(particles.drift_origin() == particles.generation());
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::append_lattice") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  sph::r[particles.append(sph::ParticleType::fixed)] = {-1.0, -1.0};
+  const auto lattice = sph::append_lattice(particles,
+                                           sph::ParticleType::fluid,
+                                           Vec{1.0, 2.0},
+                                           0.5,
+                                           {3, 2});
+  REQUIRE(std::ranges::size(lattice) == 6);
+  CHECK(std::ranges::size(particles.fluid()) == 6);
+  CHECK(sph::r[lattice[0]] == Vec{1.0, 2.0});
+  CHECK(sph::r[lattice[1]] == Vec{1.0, 2.5});
+  CHECK(sph::r[lattice[2]] == Vec{1.5, 2.0});
+  CHECK(sph::r[lattice[5]] == Vec{2.0, 2.5});
+  CHECK(sph::r[particles.fixed()[0]] == Vec{-1.0, -1.0});
+}
+
+TEST_CASE("sph::append_box") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  const auto box = sph::append_box(particles,
+                                   sph::ParticleType::fluid,
+                                   geom::BBox{Vec{0.0, 0.0}, Vec{2.0, 1.0}},
+                                   0.5);
+  REQUIRE(std::ranges::size(box) == 8);
+  CHECK(sph::r[box[0]] == Vec{0.25, 0.25});
+  CHECK(sph::r[box[7]] == Vec{1.75, 0.75});
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::split_particles") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  h[particles] = 0.1;
+  for (const PV a : particles.append_n(sph::ParticleType::fluid, 2)) {
+    sph::r[a] = {static_cast<double>(a.index()), 0.0};
+    v[a] = {1.0, 2.0};
+    m[a] = 4.0;
+    rho[a] = 1.0;
+  }
+  sph::r[particles.append(sph::ParticleType::fixed)] = {0.0, -1.0};
+
+  // Split the first particle, ensure the mass and momentum are conserved.
+  const auto num_split =
+      sph::split_particles(particles, [](PV a) { return a.index() == 0; });
+  CHECK(num_split == 1);
+  REQUIRE(std::ranges::size(particles.fluid()) == 5);
+  CHECK(std::ranges::size(particles.fixed()) == 1);
+  double total_mass = 0.0;
+  Vec<double, 2> total_momentum{};
+  Vec<double, 2> center_of_mass{};
+  for (const PV a : particles.fluid()) {
+    total_mass += m[a];
+    total_momentum += m[a] * v[a];
+    center_of_mass += m[a] * sph::r[a];
+  }
+  CHECK(total_mass == 8.0);
+  CHECK(total_momentum == Vec{8.0, 16.0});
+  CHECK(center_of_mass / total_mass == Vec{0.5, 0.0});
+  CHECK(sph::r[particles.fixed()[0]] == Vec{0.0, -1.0});
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::merge_particles") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  h[particles] = 0.1;
+  const auto fluid = particles.append_n(sph::ParticleType::fluid, 4);
+  sph::r[fluid[0]] = {0.0, 0.0};
+  sph::r[fluid[1]] = {0.05, 0.0};
+  sph::r[fluid[2]] = {1.0, 0.0};
+  sph::r[fluid[3]] = {2.0, 0.0};
+  for (const PV a : fluid) {
+    v[a] = {static_cast<double>(a.index()), 1.0};
+    m[a] = static_cast<double>(a.index() + 1);
+    rho[a] = 1000.0;
+  }
+  const auto fixed = particles.append(sph::ParticleType::fixed);
+  sph::r[fixed] = {0.0, -0.05};
+  m[fixed] = 1.0;
+  rho[fixed] = 1000.0;
+
+  // Build the mesh.
+  geom::Surface<Vec<double, 2>> domain;
+  domain.append_vert({-1.0, -1.0});
+  domain.append_vert({3.0, -1.0});
+  domain.append_vert({3.0, 1.0});
+  domain.append_vert({-1.0, 1.0});
+  domain.append_face({0, 1});
+  domain.append_face({1, 2});
+  domain.append_face({2, 3});
+  domain.append_face({3, 0});
+  sph::ParticleMesh mesh{
+      geom::GridSearch{0.1},
+      geom::GridFaceSearch{0.1},
+      geom::RecursiveInertialBisection{},
+      geom::SparsePixelatedPartition{0.2, geom::KMeansClustering{}},
+  };
+  mesh.update(domain, particles, [](PV /*a*/) { return 0.1; });
+
+  // Compute the totals before the merge.
+  const auto compute_totals = [&particles] {
+    double total_mass = 0.0;
+    Vec<double, 2> total_momentum{};
+    Vec<double, 2> center_of_mass{};
+    for (const PV a : particles.fluid()) {
+      total_mass += m[a];
+      total_momentum += m[a] * v[a];
+      center_of_mass += m[a] * sph::r[a];
+    }
+    return std::tuple{total_mass, total_momentum, center_of_mass / total_mass};
+  };
+  const auto [total_mass, total_momentum, center_of_mass] = compute_totals();
+
+  // Merge the first three particles. The third one has no candidate
+  // neighbors, and the fixed particle shall not be merged.
+  const auto num_merged = sph::merge_particles(mesh, particles, [](PV a) {
+    return a.index() < 3;
+  });
+  CHECK(num_merged == 1);
+
+  // Ensure the mass, momentum and center of mass are conserved.
+  const auto [new_total_mass, new_total_momentum, new_center_of_mass] =
+      compute_totals();
+  CHECK_APPROX_EQ(new_total_mass, total_mass);
+  CHECK_APPROX_EQ(new_total_momentum, total_momentum);
+  CHECK_APPROX_EQ(new_center_of_mass, center_of_mass);
+
+  // Ensure the merged particle is placed at the center of mass of the pair,
+  // and the slot of its partner is freed.
+  REQUIRE(std::ranges::size(particles.fluid()) == 3);
+  REQUIRE(std::ranges::size(particles.fixed()) == 1);
+  const auto merged = particles.fluid()[0];
+  CHECK(m[merged] == 3.0);
+  CHECK_APPROX_EQ(sph::r[merged], Vec{0.1 / 3.0, 0.0});
+  CHECK_APPROX_EQ(v[merged], Vec{2.0 / 3.0, 1.0});
+  CHECK_APPROX_EQ(rho[merged], 1000.0);
+  CHECK(sph::r[particles.fluid()[1]] == Vec{1.0, 0.0});
+  CHECK(m[particles.fluid()[1]] == 3.0);
+  CHECK(sph::r[particles.fluid()[2]] == Vec{2.0, 0.0});
+  CHECK(m[particles.fluid()[2]] == 4.0);
+  CHECK(sph::r[particles.fixed()[0]] == Vec{0.0, -0.05});
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::ParticleArray::park") {
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  for (const PV a : particles.append_n(sph::ParticleType::fluid, 3)) {
+    m[a] = static_cast<double>(a.index());
+  }
+  m[particles.append(sph::ParticleType::fixed)] = 3.0;
+
+  // Park the first particle, the last fluid one is moved into its slot.
+  const auto layout_generation = particles.layout_generation();
+  CHECK(particles.park(0) == 2);
+  particles.relayout();
+  CHECK(particles.layout_generation() != layout_generation);
+  CHECK(particles.num_parked() == 1);
+  REQUIRE(std::ranges::size(particles.fluid()) == 2);
+  CHECK(m[particles.fluid()[0]] == 2.0);
+  CHECK(m[particles.fluid()[1]] == 1.0);
+  REQUIRE(std::ranges::size(particles.parked()) == 1);
+  CHECK(particles.parked()[0].index() == 2);
+  CHECK(particles.parked()[0].is_parked());
+
+  // Parked particles are excluded from all the particles, and the fixed
+  // particles are not moved.
+  REQUIRE(std::ranges::size(particles.all()) == 3);
+  CHECK(m[particles.all()[0]] == 2.0);
+  CHECK(m[particles.all()[1]] == 1.0);
+  CHECK(m[particles.all()[2]] == 3.0);
+  CHECK(particles.fixed()[0].index() == 3);
+
+  // Unpark the particle, its slot is reused.
+  const auto a = particles.unpark();
+  particles.relayout();
+  CHECK(a.index() == 2);
+  CHECK(a.is_fluid());
+  CHECK(particles.num_parked() == 0);
+  CHECK(std::ranges::size(particles.fluid()) == 3);
+  CHECK(std::ranges::size(particles.all()) == 4);
+}
+
+TEST_CASE("sph::OpenBoundary") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  const auto inlet = particles.append(sph::ParticleType::fluid);
+  const auto outlet = particles.append(sph::ParticleType::fluid);
+  sph::r[inlet] = {-0.1, 0.0};
+  sph::r[outlet] = {11.5, 0.0};
+  sph::r[particles.append(sph::ParticleType::fixed)] = {5.0, -1.0};
+  const auto check_fixed = [&particles] {
+    REQUIRE(std::ranges::size(particles.fixed()) == 1);
+    CHECK(sph::r[particles.fixed()[0]] == Vec{5.0, -1.0});
+  };
+
+  // Channel along the X axis, from 0 to 10.
+  sph::OpenBoundary boundary{Vec{0.0, 0.0},
+                             Vec{1.0, 0.0},
+                             Vec{10.0, 0.0},
+                             Vec{-1.0, 0.0},
+                             /*depth=*/1.0,
+                             /*v_in=*/2.0,
+                             /*rho_in=*/1000.0};
+
+  // Inlet particle gets the inflow state, outlet particle is parked.
+  boundary.update(particles);
+  CHECK(particles.num_parked() == 1);
+  CHECK(particles.parked()[0].index() == 1);
+  CHECK(std::ranges::size(particles.fluid()) == 1);
+  CHECK(std::ranges::size(particles.all()) == 2);
+  CHECK(v[inlet] == Vec{2.0, 0.0});
+  CHECK(rho[inlet] == 1000.0);
+  check_fixed();
+
+  // Inlet particle enters the domain, parked particle is recycled behind it.
+  sph::r[inlet] = {0.25, 0.0};
+  boundary.update(particles);
+  CHECK(particles.num_parked() == 0);
+  REQUIRE(particles.size() == 3);
+  CHECK(std::ranges::size(particles.fluid()) == 2);
+  CHECK(sph::r[particles[1]] == Vec{-0.75, 0.0});
+  CHECK(v[particles[1]] == Vec{2.0, 0.0});
+  check_fixed();
+
+  // Next particle enters the domain, no free slots left, so a new particle
+  // is appended.
+  sph::r[particles[1]] = {0.125, 0.0};
+  boundary.update(particles);
+  REQUIRE(particles.size() == 4);
+  CHECK(std::ranges::size(particles.fluid()) == 3);
+  CHECK(sph::r[particles[2]] == Vec{-0.875, 0.0});
+  check_fixed();
+
+  // First particle exits the domain, and is parked. Last fluid particle is
+  // moved into its slot, and keeps being the inlet particle.
+  sph::r[particles[0]] = {11.5, 0.0};
+  boundary.update(particles);
+  CHECK(particles.num_parked() == 1);
+  CHECK(particles.parked()[0].index() == 2);
+  REQUIRE(std::ranges::size(particles.fluid()) == 2);
+  CHECK(sph::r[particles[0]] == Vec{-0.875, 0.0});
+  CHECK(v[particles[0]] == Vec{2.0, 0.0});
+  check_fixed();
+
+  // Moved particle enters the domain, and the parked one is recycled.
+  sph::r[particles[0]] = {0.5, 0.0};
+  boundary.update(particles);
+  CHECK(particles.num_parked() == 0);
+  REQUIRE(particles.size() == 4);
+  CHECK(std::ranges::size(particles.fluid()) == 3);
+  CHECK(sph::r[particles[2]] == Vec{-0.5, 0.0});
+  CHECK(v[particles[2]] == Vec{2.0, 0.0});
+  check_fixed();
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
@@ -0,0 +1,121 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+
+#include "tit/core/assert.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/profiler.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/bbox.hpp"
+#include "tit/geom/surface.hpp"
+#include "tit/par/algorithms.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/particle_array.hpp"
+
+namespace tit::sph {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Append a lattice of particles of the specified type.
+///
+/// Particles are placed at `origin + spacing * (i_1, ..., i_d)`, where
+/// `0 <= i_k < counts[k]`. Last index varies the fastest.
+///
+/// @returns Range of the appended particles.
+template<particle_array<r> ParticleArray>
+  requires (!has_uniform<ParticleArray>(r))
+auto append_lattice(
+    ParticleArray& particles,
+    ParticleType type,
+    const particle_vec_t<ParticleArray>& origin,
+    particle_num_t<ParticleArray> spacing,
+    const std::array<std::size_t, particle_dim_v<ParticleArray>>& counts) {
+  TIT_PROFILE_SECTION("append_lattice()");
+  using PV = ParticleView<ParticleArray>;
+  using Num = particle_num_t<ParticleArray>;
+  constexpr auto Dim = particle_dim_v<ParticleArray>;
+  TIT_ASSERT(spacing > Num{0}, "Lattice spacing must be positive!");
+
+  const auto count = std::ranges::fold_left(counts,
+                                            std::size_t{1},
+                                            std::multiplies{});
+  auto appended = particles.append_n(type, count);
+  if (count == 0) return appended;
+
+  const auto first = appended.front().index();
+  par::for_each(appended, [&origin, spacing, &counts, first](PV a) {
+    auto offset = a.index() - first;
+    auto r_a = origin;
+    for (std::size_t i = Dim; i-- > 0;) {
+      r_a[i] += spacing * static_cast<Num>(offset % counts[i]);
+      offset /= counts[i];
+    }
+    r[a] = r_a;
+  });
+
+  return appended;
+}
+
+/// Fill the box with a lattice of particles of the specified type.
+///
+/// Particles are placed at the centers of the lattice cells that fit into
+/// the box, starting from its lower corner.
+///
+/// @returns Range of the appended particles.
+template<particle_array<r> ParticleArray>
+  requires (!has_uniform<ParticleArray>(r))
+auto append_box(ParticleArray& particles,
+                ParticleType type,
+                const geom::BBox<particle_vec_t<ParticleArray>>& box,
+                particle_num_t<ParticleArray> spacing) {
+  using Num = particle_num_t<ParticleArray>;
+  constexpr auto Dim = particle_dim_v<ParticleArray>;
+  TIT_ASSERT(spacing > Num{0}, "Lattice spacing must be positive!");
+
+  const auto extents = box.extents();
+  std::array<std::size_t, Dim> counts{};
+  for (std::size_t i = 0; i < Dim; ++i) {
+    counts[i] = static_cast<std::size_t>(floor(extents[i] / spacing));
+  }
+  return append_lattice(particles,
+                        type,
+                        box.low() + particle_vec_t<ParticleArray>(spacing / 2),
+                        spacing,
+                        counts);
+}
+
+/// Append a particle of the specified type at each vertex of the surface.
+///
+/// Surface is expected to be tessellated with the particle spacing.
+///
+/// @returns Range of the appended particles.
+template<particle_array<r> ParticleArray>
+  requires (!has_uniform<ParticleArray>(r))
+auto append_surface(ParticleArray& particles,
+                    ParticleType type,
+                    const geom::Surface<particle_vec_t<ParticleArray>>& surf) {
+  TIT_PROFILE_SECTION("append_surface()");
+  using PV = ParticleView<ParticleArray>;
+
+  auto appended = particles.append_n(type, surf.num_verts());
+  if (surf.num_verts() == 0) return appended;
+
+  const auto first = appended.front().index();
+  par::for_each(appended, [&surf, first](PV a) {
+    r[a] = surf.vert(a.index() - first);
+  });
+
+  return appended;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::sph
@@ -6,18 +6,25 @@
 #pragma once
 
 #include <algorithm>
+#include <any>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iterator>
 #include <limits>
 #include <ranges>
+#include <span>
 #include <tuple>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
+#include "tit/core/arena.hpp"
 #include "tit/core/assert.hpp"
 #include "tit/core/exception.hpp"
+#include "tit/core/float.hpp"
+#include "tit/core/math.hpp"
 #include "tit/core/profiler.hpp"
 #include "tit/core/type.hpp"
 #include "tit/core/vec.hpp"
@@ -26,7 +33,10 @@
 #include "tit/geom/partition.hpp"
 #include "tit/geom/search.hpp"
 #include "tit/par/algorithms.hpp"
+#include "tit/par/atomic.hpp"
 #include "tit/par/control.hpp"
+#include "tit/par/memory.hpp"
+#include "tit/par/task_group.hpp"
 #include "tit/sph/field.hpp"
 #include "tit/sph/particle_array.hpp"
 
@@ -50,15 +60,36 @@ public:
   /// @param face_search_func Face search function.
   /// @param partition_func Geometry partitioning function.
   /// @param interface_partition_func Interface partitioning function.
+  /// @param repartition_interval Number of updates between the full
+  ///                             repartitionings. In between, the primary
+  ///                             partitioning is updated incrementally.
+  /// @param skin Relative padding of the search radii. Padded adjacency is
+  ///             reused while the particles stay within the padded radii.
+  ///             Adjacent particles may be farther than the search radius.
   constexpr explicit ParticleMesh(
       SearchFunc search_func = {},
       FaceSearchFunc face_search_func = {},
       PartitionFunc partition_func = {},
-      InterfacePartitionFunc interface_partition_func = {}) noexcept
+      InterfacePartitionFunc interface_partition_func = {},
+      std::size_t repartition_interval = 1,
+      float64_t skin = 0.0) noexcept
       : search_func_{std::move(search_func)},
         face_search_func_{std::move(face_search_func)},
         partition_func_{std::move(partition_func)},
-        interface_partition_func_{std::move(interface_partition_func)} {}
+        interface_partition_func_{std::move(interface_partition_func)},
+        repartition_interval_{repartition_interval},
+        skin_{skin} {
+    TIT_ASSERT(repartition_interval_ > 0,
+               "Repartition interval must be positive!");
+    TIT_ASSERT(skin_ >= 0.0, "Skin must be non-negative!");
+  }
+
+  /// Check if the adjacency graph is up to date with the particle positions.
+  template<particle_array ParticleArray>
+  constexpr auto is_current(const ParticleArray& particles) const noexcept
+      -> bool {
+    return generation_ == particles.generation();
+  }
 
   /// Adjacent particles.
   template<particle_view PV>
@@ -81,6 +112,37 @@ public:
            });
   }
 
+  /// Adjacent faces' vertex particles with the cached kernel fluxes over
+  /// the faces.
+  ///
+  /// Fluxes must be computed with `update_face_fluxes` after the last update.
+  template<class Domain, particle_view PV>
+  constexpr auto face_fluxes(const Domain& domain, PV a) const noexcept {
+    TIT_ASSERT(face_fluxes_valid_, "Face fluxes are not computed!");
+    using FluxVec = ParticleVec_<particle_vec_t<PV>>;
+    const auto* const fluxes = std::any_cast<FluxVec>(&face_fluxes_);
+    TIT_ASSERT(fluxes != nullptr, "Face fluxes have a different type!");
+    auto& particles = a.array();
+    const auto& face_indices = face_adjacency_[a.index()];
+    const auto offset = face_flux_offsets_[a.index()];
+    return std::views::iota(std::size_t{0}, face_indices.size()) |
+           std::views::transform([&domain,
+                                  &particles,
+                                  &face_indices,
+                                  fluxes,
+                                  offset](std::size_t k) {
+             const auto& [... vert_indices] =
+                 domain.face_verts(face_indices[k]);
+             return std::pair{std::tuple{particles.fixed()[vert_indices]...},
+                              (*fluxes)[offset + k]};
+           });
+  }
+
+  /// Primary part index of each particle, one part per thread.
+  constexpr auto primary_parts() const noexcept {
+    return std::span{std::as_const(primary_parts_)};
+  }
+
   /// Unique pairs of the adjacent particles.
   template<particle_array ParticleArray>
   constexpr auto pairs(ParticleArray& particles) const noexcept {
@@ -111,6 +173,16 @@ public:
               const SearchRadiusFunc& radius_func) {
     TIT_PROFILE_SECTION("ParticleMesh::update()");
 
+    // Nothing to do if the positions have not changed.
+    if (is_current(particles)) return;
+    generation_ = particles.generation();
+
+    // Positions have changed, so the cached face fluxes are stale.
+    face_fluxes_valid_ = false;
+
+    // Keep the adjacency graphs if the padding still covers the search radii.
+    if (can_reuse_(particles, radius_func)) return;
+
     // Update the adjacency graphs.
     search_(domain, particles, radius_func);
 
@@ -118,8 +190,73 @@ public:
     partition_(particles);
   }
 
+  /// Compute and cache the kernel fluxes over the adjacent faces.
+  ///
+  /// Cache is invalidated by the next update.
+  template<class Domain, particle_array ParticleArray, class FluxFunc>
+  void update_face_fluxes(const Domain& domain,
+                          ParticleArray& particles,
+                          const FluxFunc& flux_func) {
+    TIT_PROFILE_SECTION("ParticleMesh::update_face_fluxes()");
+    using PV = ParticleView<ParticleArray>;
+    using Num = particle_num_t<PV>;
+    using FluxVec = ParticleVec_<particle_vec_t<PV>>;
+
+    // Nothing to do if the positions have not changed since the last call.
+    if (face_fluxes_valid_) return;
+
+    // Fluxes are stored contiguously, in the order of the adjacent faces.
+    // Convert the face counts to the offsets in-place.
+    face_flux_offsets_.resize(particles.size() + 1);
+    par::for_each(particles.all(), [this](PV a) {
+      face_flux_offsets_[a.index()] = face_adjacency_[a.index()].size();
+    });
+    face_flux_offsets_.back() = 0;
+    const auto num_fluxes =
+        par::exclusive_scan(face_flux_offsets_, face_flux_offsets_.begin());
+
+    // Flux type depends on the particle array, so the storage is created
+    // when the cache is first filled.
+    if (face_fluxes_.type() != typeid(FluxVec)) face_fluxes_.emplace<FluxVec>();
+    auto& fluxes = std::any_cast<FluxVec&>(face_fluxes_);
+    fluxes.resize(num_fluxes);
+    par::for_each(particles.all(), [&domain, &flux_func, &fluxes, this](PV a) {
+      auto offset = face_flux_offsets_[a.index()];
+      for (const auto& [face, _] : (*this)[domain, a]) {
+        fluxes[offset++] = vec_cast<Num>(flux_func(face, a));
+      }
+    });
+    face_fluxes_valid_ = true;
+  }
+
 private:
 
+  template<particle_array ParticleArray, class SearchRadiusFunc>
+  auto can_reuse_(ParticleArray& particles,
+                  const SearchRadiusFunc& radius_func) const -> bool {
+    using PV = ParticleView<ParticleArray>;
+    if (skin_ <= 0.0 || search_radii_.size() != particles.size()) return false;
+    if (particles.drift_origin() != search_drift_origin_) return false;
+
+    // Distance between two particles changes at most by the sum of their
+    // displacements.
+    const auto margin = 2 * (particles.drift() - search_drift_);
+    return par::fold(
+        particles.all(),
+        true,
+        [&radius_func, margin, this](bool covered, PV a) {
+          const auto search_radius = static_cast<float64_t>(radius_func(a));
+          return covered &&
+                 search_radius + margin <= search_radii_[a.index()];
+        },
+        std::logical_and{});
+  }
+
+  template<class Num>
+  constexpr auto pad_(Num search_radius) const noexcept -> Num {
+    return search_radius * static_cast<Num>(1.0 + skin_);
+  }
+
   template<class Domain, particle_array ParticleArray, class SearchRadiusFunc>
   void search_(const Domain& domain,
                ParticleArray& particles,
@@ -127,38 +264,73 @@ private:
     TIT_PROFILE_SECTION("ParticleMesh::search()");
     using PV = ParticleView<ParticleArray>;
 
-    // Build the search index.
-    const auto positions = r[particles];
-    const auto search_index = search_func_(positions);
-    const auto face_index = face_search_func_(domain);
-
-    // Search for the neighbors.
+    // Particle search and face search are independent, so they are executed
+    // concurrently.
+    par::TaskGroup tasks{};
     adjacency_.resize(particles.size());
-    par::for_each(particles.all(), [&radius_func, &search_index, this](PV a) {
-      const auto& search_point = r[a];
-      const auto search_radius = radius_func(a);
-      TIT_ASSERT(search_radius > 0.0, "Search radius must be positive.");
-
-      auto& search_results = adjacency_[a.index()];
-      search_results.clear();
-      search_index.search(geom::BSphere{search_point, search_radius},
-                          std::back_inserter(search_results));
-      std::ranges::sort(search_results);
+    face_adjacency_.resize(particles.size());
+    for (const PV a : particles.parked()) {
+      adjacency_[a.index()].clear();
+      face_adjacency_[a.index()].clear();
+    }
+
+    // Remember the drift at the time of the search, so that the padded
+    // adjacency could be reused later.
+    search_radii_.resize(particles.size());
+    search_drift_origin_ = particles.drift_origin();
+    search_drift_ = particles.drift();
+
+    // Search for the neighbors. Search radii may differ between the particles,
+    // in which case the adjacency graph is not symmetric. Parked particles
+    // neither search nor are found.
+    uniform_radius_ = true;
+    tasks.run([&particles, &radius_func, this] {
+      if (particles.size() == 0) return;
+      const auto positions = r[particles];
+      const auto search_index = search_func_(positions);
+      const auto first_radius = radius_func(particles[0]);
+      par::for_each(particles.all(), [&particles,
+                                      &radius_func,
+                                      &search_index,
+                                      first_radius,
+                                      this](PV a) {
+        const auto& search_point = r[a];
+        const auto search_radius = radius_func(a);
+        TIT_ASSERT(search_radius > 0.0, "Search radius must be positive.");
+        if (!bitwise_equal(search_radius, first_radius)) {
+          par::store(uniform_radius_, false);
+        }
+        const auto padded_radius = pad_(search_radius);
+        search_radii_[a.index()] = static_cast<float64_t>(padded_radius);
+
+        auto& search_results = adjacency_[a.index()];
+        search_results.clear();
+        search_index.search(geom::BSphere{search_point, padded_radius},
+                            std::back_inserter(search_results));
+        std::erase_if(search_results, [&particles](std::size_t b) {
+          return particles.has_type(b, ParticleType::parked);
+        });
+        std::ranges::sort(search_results);
+      });
     });
 
     // Search for the adjacent boundary faces.
-    face_adjacency_.resize(particles.size());
-    par::for_each(particles.all(), [&radius_func, &face_index, this](PV a) {
-      const auto& search_point = r[a];
-      const auto search_radius = radius_func(a);
-      TIT_ASSERT(search_radius > 0.0, "Search radius must be positive.");
-
-      auto& face_results = face_adjacency_[a.index()];
-      face_results.clear();
-      face_index.search(geom::BSphere{search_point, search_radius},
-                        std::back_inserter(face_results));
-      std::ranges::sort(face_results);
+    tasks.run([&domain, &particles, &radius_func, this] {
+      const auto face_index = face_search_func_(domain);
+      par::for_each(particles.all(), [&radius_func, &face_index, this](PV a) {
+        const auto& search_point = r[a];
+        const auto search_radius = radius_func(a);
+        TIT_ASSERT(search_radius > 0.0, "Search radius must be positive.");
+
+        auto& face_results = face_adjacency_[a.index()];
+        face_results.clear();
+        face_index.search(geom::BSphere{search_point, pad_(search_radius)},
+                          std::back_inserter(face_results));
+        std::ranges::sort(face_results);
+      });
     });
+
+    tasks.wait();
   }
 
   template<particle_array ParticleArray>
@@ -175,13 +347,14 @@ private:
     TIT_ENSURE(num_parts < max_num_parts,
                "Number of parts exceeded the limit of {}.",
                max_num_parts);
-    std::vector parts(particles.size(),
-                      PartVec_(static_cast<PartIndex_>(num_parts - 1)));
+    ArenaVector<PartVec_> parts(
+        particles.size(),
+        PartVec_(static_cast<PartIndex_>(num_parts - 1)));
 
     // Build the multi-level partitioning.
     const auto positions = r[particles];
-    std::vector<std::size_t> interface{};
-    std::vector<std::size_t> prev_interface{};
+    ArenaVector<std::size_t> interface{};
+    ArenaVector<std::size_t> prev_interface{};
     for (std::size_t level = 0; level < num_levels; ++level) {
       const auto is_first_level = level == 0;
       const auto is_last_level = level == (num_levels - 1);
@@ -191,9 +364,14 @@ private:
           parts | std::views::transform(
                       [level](PartVec_& part) -> auto& { return part[level]; });
       if (is_first_level) {
-        partition_func_(positions,
-                        level_parts,
-                        static_cast<PartIndex_>(num_threads));
+        partition_primary_(positions,
+                           num_threads,
+                           particles.layout_generation());
+        par::for_each(std::views::zip(level_parts, primary_parts_),
+                      [](auto part_and_primary_part) {
+                        auto&& [part, primary_part] = part_and_primary_part;
+                        part = primary_part;
+                      });
       } else {
         interface_partition_func_(
             permuted_view(positions, interface),
@@ -213,7 +391,7 @@ private:
                                      &is_interface](const auto& current) {
         interface.resize(std::ranges::size(current));
         interface.erase(
-            par::unstable_copy_if(current, interface.begin(), is_interface),
+            par::stable_copy_if(current, interface.begin(), is_interface),
             interface.end());
       };
       if (is_first_level) {
@@ -231,7 +409,16 @@ private:
          std::views::enumerate(adjacency_) | std::views::as_const) {
       const auto index = static_cast<std::size_t>(index_);
       for (const auto neighbor : neighbors) {
-        if (neighbor >= index) break;
+        // Pair is assembled by the particle with the larger index. If the
+        // search radii differ, the pair is assembled by the particle with the
+        // smaller index when it was not found by the other one.
+        if (neighbor >= index) {
+          if (uniform_radius_) break;
+          if (neighbor == index ||
+              std::ranges::binary_search(adjacency_[neighbor], index)) {
+            continue;
+          }
+        }
         const auto level = find_true(parts[index] == parts[neighbor]);
         TIT_ASSERT(level >= 0, "No common partition index!");
         const auto part = parts[index][level];
@@ -240,20 +427,155 @@ private:
     }
   }
 
+  template<class Positions>
+  void partition_primary_(Positions&& positions,
+                          std::size_t num_parts,
+                          std::size_t layout_generation) {
+    // Try to update the previous partitioning incrementally, if it was
+    // computed for the same particles and the update budget is not exhausted
+    // yet. Particle count alone is not enough, since the particles may be
+    // reordered or their slots may be reused.
+    const auto num_points = std::ranges::size(positions);
+    if (num_incremental_updates_ + 1 < repartition_interval_ &&
+        primary_layout_generation_ == layout_generation &&
+        primary_parts_.size() == num_points &&
+        primary_part_sizes_.size() == num_parts) {
+      if (rebalance_primary_()) {
+        num_incremental_updates_ += 1;
+        return;
+      }
+    }
+
+    // Partition the particles from scratch.
+    num_incremental_updates_ = 0;
+    primary_layout_generation_ = layout_generation;
+    primary_parts_.resize(num_points);
+    partition_func_(positions,
+                    primary_parts_,
+                    static_cast<PartIndex_>(num_parts));
+    primary_part_sizes_.resize(num_parts);
+    par::histogram(primary_parts_, primary_part_sizes_, std::identity{});
+  }
+
+  auto rebalance_primary_() -> bool {
+    TIT_PROFILE_SECTION("ParticleMesh::rebalance_primary()");
+    const auto num_points = primary_parts_.size();
+    const auto num_parts = primary_part_sizes_.size();
+    const auto max_part_size = static_cast<std::size_t>(
+        max_imbalance_ * static_cast<double>(num_points) /
+        static_cast<double>(num_parts));
+
+    // Collect the boundary particles, whose neighbors span several parts.
+    // Candidates are kept in order, so that the result does not depend on the
+    // task scheduling.
+    ArenaVector<std::size_t> candidates(num_points);
+    candidates.erase(
+        par::stable_copy_if(std::views::iota(std::size_t{0}, num_points),
+                            candidates.begin(),
+                            [this](std::size_t a) {
+                              return std::ranges::any_of(
+                                  permuted_view(primary_parts_, adjacency_[a]),
+                                  std::bind_front(std::not_equal_to{},
+                                                  primary_parts_[a]));
+                            }),
+        candidates.end());
+
+    // For each boundary particle, find the adjacent part with the largest
+    // number of neighbors, ties are broken in favor of the smaller part.
+    // Neighbors are counted by the part in a single pass.
+    ArenaVector<PartIndex_> targets(candidates.size());
+    par::for_each(std::views::zip(candidates, targets), [this](auto pair) {
+      auto&& [a, target] = pair;
+      const auto part = primary_parts_[a];
+      const auto neighbor_parts = permuted_view(primary_parts_, adjacency_[a]);
+      std::array<std::uint32_t, max_num_parts_> counts{};
+      for (const auto neighbor_part : neighbor_parts) {
+        counts[neighbor_part] += 1;
+      }
+      target = part;
+      std::uint32_t target_count = 0;
+      for (const auto neighbor_part : neighbor_parts) {
+        if (neighbor_part == part || neighbor_part == target) continue;
+        const auto count = counts[neighbor_part];
+        if (count > target_count ||
+            (count == target_count &&
+             primary_part_sizes_[neighbor_part] <
+                 primary_part_sizes_[target])) {
+          target = neighbor_part;
+          target_count = count;
+        }
+      }
+    });
+
+    // Migrate the boundary particles. A particle is migrated if it reduces the
+    // edge cut, if it keeps the edge cut and improves the balance, or if it
+    // leaves the overloaded part. Target part must not become overloaded.
+    // Neighbors may have been migrated already, so the counts are refreshed.
+    for (const auto& [a, target] : std::views::zip(candidates, targets)) {
+      const auto part = primary_parts_[a];
+      if (target == part) continue;
+      auto& part_size = primary_part_sizes_[part];
+      auto& target_size = primary_part_sizes_[target];
+      if (target_size >= max_part_size) continue;
+      std::size_t part_count = 0;
+      std::size_t target_count = 0;
+      for (const auto neighbor_part :
+           permuted_view(primary_parts_, adjacency_[a])) {
+        part_count += static_cast<std::size_t>(neighbor_part == part);
+        target_count += static_cast<std::size_t>(neighbor_part == target);
+      }
+      if (target_count < part_count) {
+        if (part_size <= max_part_size || target_size + 1 >= part_size) {
+          continue;
+        }
+      } else if (target_count == part_count) {
+        if (target_size + 1 >= part_size) continue;
+      }
+      primary_parts_[a] = target;
+      part_size -= 1, target_size += 1;
+    }
+
+    // Check that the balance is within the tolerance.
+    return std::ranges::max(primary_part_sizes_) <= max_part_size;
+  }
+
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   static constexpr std::size_t max_num_levels_ = 8;
+  static constexpr double max_imbalance_ = 1.05;
 
   using PartIndex_ = std::uint8_t;
   using PartVec_ = Vec<PartIndex_, max_num_levels_>;
+  static constexpr std::size_t max_num_parts_ =
+      std::size_t{std::numeric_limits<PartIndex_>::max()} + 1;
+
+  // Per-particle arrays are first-touched by the threads that process them.
+  // The outer arrays may be backed by the huge pages, the adjacency lists
+  // they hold are small vectors allocated on the heap.
+  template<class Val>
+  using ParticleVec_ = std::vector<Val, par::FirstTouchAllocator<Val>>;
 
-  std::vector<std::vector<std::size_t>> adjacency_;
+  ParticleVec_<std::vector<std::size_t>> adjacency_;
   std::vector<std::vector<std::pair<std::size_t, std::size_t>>> block_edges_;
-  std::vector<std::vector<std::size_t>> face_adjacency_;
+  ParticleVec_<std::vector<std::size_t>> face_adjacency_;
+  ParticleVec_<std::size_t> face_flux_offsets_;
+  std::any face_fluxes_;
+  bool face_fluxes_valid_ = false;
   [[no_unique_address]] SearchFunc search_func_;
   [[no_unique_address]] FaceSearchFunc face_search_func_;
   [[no_unique_address]] PartitionFunc partition_func_;
   [[no_unique_address]] InterfacePartitionFunc interface_partition_func_;
+  std::size_t repartition_interval_;
+  std::size_t num_incremental_updates_ = 0;
+  std::size_t primary_layout_generation_ = 0;
+  bool uniform_radius_ = true;
+  float64_t skin_ = 0.0;
+  std::size_t generation_ = std::numeric_limits<std::size_t>::max();
+  std::size_t search_drift_origin_ = 0;
+  float64_t search_drift_ = 0.0;
+  ParticleVec_<float64_t> search_radii_;
+  std::vector<PartIndex_> primary_parts_;
+  std::vector<std::size_t> primary_part_sizes_;
 
 }; // class ParticleMesh
 
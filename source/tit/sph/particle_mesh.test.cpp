@@ -0,0 +1,276 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tit/core/math.hpp"
+#include "tit/core/type.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/face_search.hpp"
+#include "tit/geom/partition.hpp"
+#include "tit/geom/search.hpp"
+#include "tit/geom/surface.hpp"
+#include "tit/par/control.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/kernel_width.hpp"
+#include "tit/sph/particle_array.hpp"
+#include "tit/sph/particle_generator.hpp"
+#include "tit/sph/particle_mesh.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+using KernelWidth = sph::AdaptiveKernelWidth<double>;
+
+// Equations stub that defines the particle fields.
+struct Equations final {
+  static constexpr auto required_fields =
+      TypeSet{sph::r} | KernelWidth::required_fields;
+  static constexpr auto modified_fields =
+      TypeSet{sph::r, m, rho} | KernelWidth::modified_fields;
+};
+
+using ParticleArray = decltype(sph::ParticleArray{sph::Space<double, 2>{},
+                                                  Equations{}});
+using PV = sph::ParticleView<ParticleArray>;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::ParticleMesh[variable width]") {
+  par::set_num_threads(4);
+
+  // Generate the fluid particles of three different masses, and two fixed
+  // particles with the predefined widths.
+  constexpr double dr = 0.1;
+  constexpr double rho_0 = 1000.0;
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  sph::append_lattice(particles,
+                      sph::ParticleType::fluid,
+                      Vec<double, 2>(dr / 2),
+                      dr,
+                      {std::size_t{10}, std::size_t{10}});
+  for (const PV a : particles.fluid()) {
+    m[a] = rho_0 * pow2(dr) * (1.0 + 0.5 * static_cast<double>(a.index() % 3));
+    rho[a] = rho_0;
+  }
+  for (const PV a : particles.append_n(sph::ParticleType::fixed, 2)) {
+    sph::r[a] = {-dr, static_cast<double>(a.index() % 2) * dr};
+    h[a] = dr;
+    m[a] = rho_0 * pow2(dr);
+    rho[a] = rho_0;
+  }
+
+  // Compute the widths of the fluid particles from their volumes, widths
+  // of the fixed particles must remain unchanged.
+  constexpr double eta = 1.3;
+  const auto generation = particles.generation();
+  const KernelWidth kernel_width{eta};
+  kernel_width.update(particles);
+  CHECK(particles.generation() != generation);
+  // Widths are unchanged by the repeated update, so the particles are not
+  // touched.
+  const auto updated_generation = particles.generation();
+  kernel_width.update(particles);
+  CHECK(particles.generation() == updated_generation);
+  for (const PV a : particles.fluid()) {
+    CHECK_APPROX_EQ(h[a], eta * sqrt(m[a] / rho[a]));
+  }
+  for (const PV a : particles.fixed()) CHECK(h[a] == dr);
+
+  // Build the mesh with the search radii proportional to the widths. Since
+  // the radii differ, the adjacency graph is not symmetric, and each pair
+  // must be assembled exactly once by either of the particles.
+  geom::Surface<Vec<double, 2>> domain;
+  domain.append_vert({-1.0, -1.0});
+  domain.append_vert({2.0, -1.0});
+  domain.append_vert({2.0, 2.0});
+  domain.append_vert({-1.0, 2.0});
+  domain.append_face({0, 1});
+  domain.append_face({1, 2});
+  domain.append_face({2, 3});
+  domain.append_face({3, 0});
+  const auto radius = [](PV a) { return 2 * h[a]; };
+  sph::ParticleMesh mesh{
+      geom::GridSearch{2 * dr},
+      geom::GridFaceSearch{2 * dr},
+      geom::RecursiveInertialBisection{},
+      geom::SparsePixelatedPartition{4 * dr, geom::KMeansClustering{}},
+  };
+  mesh.update(domain, particles, radius);
+
+  // Compare the assembled pairs with the brute force ones.
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  for (const auto& block : mesh.block_pairs(particles)) {
+    for (const auto& [a, b] : block) {
+      pairs.emplace_back(std::minmax({a.index(), b.index()}));
+    }
+  }
+  std::ranges::sort(pairs);
+  std::vector<std::pair<std::size_t, std::size_t>> expected_pairs;
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    for (std::size_t j = i + 1; j < particles.size(); ++j) {
+      const auto a = particles[i];
+      const auto b = particles[j];
+      if (norm(sph::r[a, b]) <= std::max(radius(a), radius(b))) {
+        expected_pairs.emplace_back(i, j);
+      }
+    }
+  }
+  CHECK(pairs == expected_pairs);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::ParticleMesh[incremental partitioning]") {
+  constexpr std::size_t num_threads = 4;
+  par::set_num_threads(num_threads);
+
+  // Generate the fluid particles.
+  constexpr double dr = 0.1;
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  sph::append_lattice(particles,
+                      sph::ParticleType::fluid,
+                      Vec<double, 2>(dr / 2),
+                      dr,
+                      {std::size_t{40}, std::size_t{40}});
+  h[particles] = dr;
+
+  // Particles drift to the right, faster at the top, so that the parts
+  // become unbalanced over time.
+  const auto advance = [&particles] {
+    for (const PV a : particles.all()) sph::r[a][0] += 0.2 * dr * sph::r[a][1];
+    particles.touch();
+  };
+
+  geom::Surface<Vec<double, 2>> domain;
+  domain.append_vert({-1.0, -1.0});
+  domain.append_vert({6.0, -1.0});
+  domain.append_vert({6.0, 5.0});
+  domain.append_vert({-1.0, 5.0});
+  domain.append_face({0, 1});
+  domain.append_face({1, 2});
+  domain.append_face({2, 3});
+  domain.append_face({3, 0});
+  const auto radius = [](PV a) { return 2 * h[a]; };
+  const auto make_mesh = [] {
+    return sph::ParticleMesh{
+        geom::GridSearch{2 * dr},
+        geom::GridFaceSearch{2 * dr},
+        geom::RecursiveInertialBisection{},
+        geom::SparsePixelatedPartition{4 * dr, geom::KMeansClustering{}},
+        /*repartition_interval=*/10,
+    };
+  };
+  const auto make_parts = [](const auto& mesh) {
+    return std::vector<std::uint8_t>(std::from_range, mesh.primary_parts());
+  };
+
+  // Perform a few incremental updates on the two meshes.
+  auto mesh = make_mesh();
+  auto other_mesh = make_mesh();
+  mesh.update(domain, particles, radius);
+  other_mesh.update(domain, particles, radius);
+  for (std::size_t step = 0; step < 5; ++step) {
+    advance();
+    mesh.update(domain, particles, radius);
+    other_mesh.update(domain, particles, radius);
+  }
+
+  SUBCASE("balance") {
+    // Parts must be balanced within the tolerance.
+    std::vector<std::size_t> part_sizes(num_threads);
+    for (const auto part : mesh.primary_parts()) {
+      REQUIRE(part < num_threads);
+      part_sizes[part] += 1;
+    }
+    const auto max_part_size = 1.05 * static_cast<double>(particles.size()) /
+                               static_cast<double>(num_threads);
+    CHECK(static_cast<double>(std::ranges::max(part_sizes)) <= max_part_size);
+  }
+  SUBCASE("determinism") {
+    // Incremental updates must not depend on the task scheduling.
+    CHECK(make_parts(mesh) == make_parts(other_mesh));
+  }
+  SUBCASE("fallback") {
+    // Partitioning must be recomputed from scratch after the layout change,
+    // which must match the partitioning of a fresh mesh.
+    particles.relayout();
+    mesh.update(domain, particles, radius);
+    auto fresh_mesh = make_mesh();
+    fresh_mesh.update(domain, particles, radius);
+    CHECK(make_parts(mesh) == make_parts(fresh_mesh));
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::ParticleMesh[face fluxes]") {
+  par::set_num_threads(4);
+
+  // Generate the fluid particles inside of the unit square, and the fixed
+  // particles at its corners, which are the face vertices.
+  constexpr double dr = 0.1;
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  sph::append_lattice(particles,
+                      sph::ParticleType::fluid,
+                      Vec<double, 2>(dr / 2),
+                      dr,
+                      {std::size_t{10}, std::size_t{10}});
+  geom::Surface<Vec<double, 2>> domain;
+  domain.append_vert({0.0, 0.0});
+  domain.append_vert({1.0, 0.0});
+  domain.append_vert({1.0, 1.0});
+  domain.append_vert({0.0, 1.0});
+  domain.append_face({0, 1});
+  domain.append_face({1, 2});
+  domain.append_face({2, 3});
+  domain.append_face({3, 0});
+  std::size_t vert_index = 0;
+  for (const PV a : particles.append_n(sph::ParticleType::fixed, 4)) {
+    sph::r[a] = domain.vert(vert_index++);
+  }
+  h[particles] = dr;
+
+  const auto radius = [](PV a) { return 2 * h[a]; };
+  sph::ParticleMesh mesh{
+      geom::GridSearch{2 * dr},
+      geom::GridFaceSearch{2 * dr},
+      geom::RecursiveInertialBisection{},
+      geom::SparsePixelatedPartition{4 * dr, geom::KMeansClustering{}},
+  };
+  mesh.update(domain, particles, radius);
+  mesh.update_face_fluxes(domain, particles, [](const auto& face, PV a) {
+    return face.center() - sph::r[a];
+  });
+
+  // Cached fluxes must match the adjacent faces of each particle.
+  std::size_t num_fluxes = 0;
+  for (const PV a : particles.all()) {
+    std::vector<Vec<double, 2>> expected_fluxes;
+    for (const auto& [face, _] : mesh[domain, a]) {
+      expected_fluxes.push_back(face.center() - sph::r[a]);
+    }
+    std::size_t k = 0;
+    for (const auto& [_, flux] : mesh.face_fluxes(domain, a)) {
+      REQUIRE(k < expected_fluxes.size());
+      CHECK(flux == expected_fluxes[k++]);
+    }
+    CHECK(k == expected_fluxes.size());
+    num_fluxes += k;
+  }
+  CHECK(num_fluxes > 0);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
@@ -0,0 +1,178 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <vector>
+
+#include "tit/core/math.hpp"
+#include "tit/core/profiler.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/par/algorithms.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/particle_array.hpp"
+#include "tit/sph/particle_mesh.hpp"
+
+namespace tit::sph {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Split the fluid particles that satisfy the predicate.
+///
+/// Each particle is replaced with `2^d` children, placed at the vertices of
+/// a cube centered at the parent, with the side of a half of the particle
+/// spacing. Children share the parent mass evenly and inherit the rest of the
+/// fields, so that mass, momentum and center of mass are conserved. If kernel
+/// width is varying, it is halved for the children.
+///
+/// @returns Number of the split particles.
+template<particle_array<r, m, rho, h> ParticleArray,
+         std::predicate<ParticleView<ParticleArray>> Pred>
+  requires (!has_uniform<ParticleArray>(r) && !has_uniform<ParticleArray>(m))
+auto split_particles(ParticleArray& particles, Pred pred) -> std::size_t {
+  TIT_PROFILE_SECTION("split_particles()");
+  using PV = ParticleView<ParticleArray>;
+  using Num = particle_num_t<ParticleArray>;
+  constexpr auto Dim = particle_dim_v<ParticleArray>;
+  constexpr std::size_t num_children = std::size_t{1} << Dim;
+
+  // Collect the parent particles.
+  const auto fluid_indices =
+      particles.fluid() | std::views::transform(&PV::index);
+  std::vector<std::size_t> parents(std::ranges::size(fluid_indices));
+  parents.erase(par::stable_copy_if(fluid_indices,
+                                    parents.begin(),
+                                    [&pred, &particles](std::size_t a) {
+                                      return pred(particles[a]);
+                                    }),
+                parents.end());
+  if (parents.empty()) return 0;
+
+  // Append the children. Parent particle becomes the first child. Fluid
+  // particles are appended after the existing ones, so parent indices stay
+  // valid.
+  const auto num_new_particles = parents.size() * (num_children - 1);
+  const auto first_child =
+      particles.append_n(ParticleType::fluid, num_new_particles)
+          .front()
+          .index();
+
+  // Place the children.
+  const auto place_children = [&particles, first_child](auto index_and_parent) {
+    const auto [index, parent] = index_and_parent;
+    const auto a = particles[parent];
+    const auto r_a = r[a];
+    const auto m_a = m[a];
+    const auto h_a = h[a];
+    const auto offset = pow(m_a / rho[a], inverse(static_cast<Num>(Dim))) / 4;
+
+    // Children are filled in the reverse order, so that the parent is
+    // overwritten the last.
+    for (std::size_t k = num_children; k-- > 0;) {
+      auto child = a;
+      if (k != 0) {
+        const auto child_index = first_child +
+                                 static_cast<std::size_t>(index) *
+                                     (num_children - 1) +
+                                 (k - 1);
+        particles.assign(child_index, parent);
+        child = particles[child_index];
+      }
+      auto r_child = r_a;
+      for (std::size_t i = 0; i < Dim; ++i) {
+        r_child[i] += ((k >> i) & 1) != 0 ? offset : -offset;
+      }
+      r[child] = r_child;
+      m[child] = m_a / static_cast<Num>(num_children);
+      if constexpr (!has_uniform<PV>(h)) h[child] = h_a / 2;
+    }
+  };
+  par::for_each(std::views::enumerate(parents), place_children);
+  particles.relayout();
+
+  return parents.size();
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Merge the close pairs of the fluid particles that satisfy the predicate.
+///
+/// Each candidate particle is paired with its nearest candidate neighbor, and
+/// mutually nearest particles are merged. Merged particle is placed at the
+/// center of mass, takes the total mass and the volume, and the mass-averaged
+/// velocity, so that mass and momentum are conserved. If kernel width is
+/// varying, it is scaled to the merged volume. Particle mesh must be up to
+/// date, and is invalidated by the merge.
+///
+/// @returns Number of the merged pairs.
+template<particle_mesh ParticleMesh,
+         particle_array<r, v, m, rho, h> ParticleArray,
+         std::predicate<ParticleView<ParticleArray>> Pred>
+  requires (!has_uniform<ParticleArray>(r) && !has_uniform<ParticleArray>(v) &&
+            !has_uniform<ParticleArray>(m) && !has_uniform<ParticleArray>(rho))
+auto merge_particles(const ParticleMesh& mesh,
+                     ParticleArray& particles,
+                     Pred pred) -> std::size_t {
+  TIT_PROFILE_SECTION("merge_particles()");
+  using PV = ParticleView<ParticleArray>;
+  using Num = particle_num_t<ParticleArray>;
+  constexpr auto Dim = particle_dim_v<ParticleArray>;
+  constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+  // Mark the candidates.
+  std::vector<std::uint8_t> is_candidate(particles.size());
+  par::for_each(particles.fluid(), [&is_candidate, &pred](PV a) {
+    is_candidate[a.index()] = pred(a) ? 1 : 0;
+  });
+
+  // Find the nearest candidate neighbor of each candidate.
+  std::vector<std::size_t> partners(particles.size(), npos);
+  par::for_each(particles.fluid(), [&mesh, &is_candidate, &partners](PV a) {
+    if (is_candidate[a.index()] == 0) return;
+    auto min_dist = std::numeric_limits<Num>::max();
+    for (const PV b : mesh[a]) {
+      if (b == a || !b.is_fluid() || is_candidate[b.index()] == 0) continue;
+      if (const auto dist = norm2(r[a, b]); dist < min_dist) {
+        min_dist = dist;
+        partners[a.index()] = b.index();
+      }
+    }
+  });
+
+  // Merge the mutually nearest pairs into the particle with the smaller
+  // index, and mark the other particle for removal.
+  std::vector<std::uint8_t> is_removed(particles.size());
+  par::for_each(particles.fluid(), [&particles, &partners, &is_removed](PV a) {
+    const auto partner = partners[a.index()];
+    if (partner == npos || partner < a.index()) return;
+    if (partners[partner] != a.index()) return;
+    const auto b = particles[partner];
+
+    const auto m_ab = m[a] + m[b];
+    const auto V_ab = m[a] / rho[a] + m[b] / rho[b];
+    r[a] = (m[a] * r[a] + m[b] * r[b]) / m_ab;
+    v[a] = (m[a] * v[a] + m[b] * v[b]) / m_ab;
+    if constexpr (!has_uniform<PV>(h)) {
+      h[a] *= pow(V_ab * rho[a] / m[a], inverse(static_cast<Num>(Dim)));
+    }
+    m[a] = m_ab;
+    rho[a] = m_ab / V_ab;
+
+    is_removed[b.index()] = 1;
+  });
+
+  // Remove the merged particles.
+  return particles.erase_if(
+      [&is_removed](PV a) { return is_removed[a.index()] != 0; });
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::sph
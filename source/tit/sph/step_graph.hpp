@@ -0,0 +1,127 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <utility>
+
+#include "tit/core/type.hpp"
+#include "tit/par/atomic.hpp"
+#include "tit/par/task_group.hpp"
+
+namespace tit::sph {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Phase of the integration step.
+///
+/// Phase declares the sets of particle fields it reads and writes.
+template<class Reads, class Writes, par::task Func>
+struct StepPhase final {
+
+  /// Set of particle fields that are read by the phase.
+  [[no_unique_address]] Reads reads;
+
+  /// Set of particle fields that are written by the phase.
+  [[no_unique_address]] Writes writes;
+
+  /// Phase function.
+  Func func;
+
+}; // struct StepPhase
+
+template<class Reads, class Writes, class Func>
+StepPhase(Reads, Writes, Func) -> StepPhase<Reads, Writes, Func>;
+
+namespace impl {
+
+template<class... Ts, class... Us>
+consteval auto intersects(TypeSet<Ts...> /*lhs*/, TypeSet<Us...> /*rhs*/)
+    -> bool {
+  return (contains_v<Ts, Us...> || ...);
+}
+
+// Does the phase depend on the other phase?
+template<class Phase, class OtherPhase>
+inline constexpr bool phase_depends_on_v =
+    intersects(decltype(Phase::writes){}, decltype(OtherPhase::reads){}) ||
+    intersects(decltype(Phase::writes){}, decltype(OtherPhase::writes){}) ||
+    intersects(decltype(Phase::reads){}, decltype(OtherPhase::writes){});
+
+// Does the I-th phase depend on the J-th phase, that precedes it?
+template<class PhaseTuple, std::size_t I, std::size_t J>
+inline constexpr bool phase_depends_on_nth_v =
+    J < I && phase_depends_on_v<std::tuple_element_t<I, PhaseTuple>,
+                                std::tuple_element_t<J, PhaseTuple>>;
+
+} // namespace impl
+
+/// Run the phases of the integration step.
+///
+/// Phase depends on all the preceding phases that write the fields it reads
+/// or writes, or read the fields it writes. Dependencies are computed at
+/// compile time. Each phase is started as soon as all the phases it depends
+/// on are finished, so that the independent phases are executed concurrently.
+template<class... Phases>
+void run_step_phases(const std::tuple<Phases...>& phases) {
+  static constexpr auto num_phases = sizeof...(Phases);
+  using PhaseTuple = std::tuple<Phases...>;
+
+  // Dependency matrix: `deps[i][j]` is set if phase `i` depends on phase `j`.
+  static constexpr auto deps = []<std::size_t... Ks>(
+                                   std::index_sequence<Ks...> /*indices*/) {
+    std::array<std::array<bool, num_phases>, num_phases> result{};
+    ((result[Ks / num_phases][Ks % num_phases] =
+          impl::phase_depends_on_nth_v<PhaseTuple,
+                                       Ks / num_phases,
+                                       Ks % num_phases>),
+     ...);
+    return result;
+  }(std::make_index_sequence<num_phases * num_phases>{});
+  static constexpr auto num_deps = [] {
+    std::array<std::ptrdiff_t, num_phases> result{};
+    for (std::size_t i = 0; i < num_phases; ++i) {
+      for (std::size_t j = 0; j < num_phases; ++j) {
+        result[i] += static_cast<std::ptrdiff_t>(deps[i][j]);
+      }
+    }
+    return result;
+  }();
+
+  // Run the phase, and then start the successors that have no more pending
+  // dependencies. The last finished dependency starts the successor.
+  auto num_pending_deps = num_deps;
+  par::TaskGroup group{};
+  const auto run_phase = [&group, &num_pending_deps, &phases](
+                             this const auto& self,
+                             std::size_t index) -> void {
+    group.run([&self, &num_pending_deps, &phases, index] {
+      [&phases, index]<std::size_t... Is>(
+          std::index_sequence<Is...> /*indices*/) {
+        ((index == Is ? std::invoke(std::get<Is>(phases).func) : void()), ...);
+      }(std::index_sequence_for<Phases...>{});
+      for (std::size_t successor = index + 1; successor < num_phases;
+           ++successor) {
+        if (!deps[successor][index]) continue;
+        const auto prev = par::fetch_and_add<par::MemOrder::acq_rel>(
+            num_pending_deps[successor],
+            -1);
+        if (prev == 1) self(successor);
+      }
+    });
+  };
+  for (std::size_t i = 0; i < num_phases; ++i) {
+    if (num_deps[i] == 0) run_phase(i);
+  }
+  group.wait();
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace tit::sph
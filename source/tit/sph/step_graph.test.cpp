@@ -0,0 +1,54 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include "tit/core/type.hpp"
+#include "tit/par/atomic.hpp"
+#include "tit/par/control.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/step_graph.hpp"
+#include "tit/testing/test.hpp"
+#include "tit/testing/utils.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::run_step_phases") {
+  par::set_num_threads(4);
+
+  // Record the order of the phases.
+  std::vector<std::size_t> order(5);
+  std::size_t counter = 0;
+  const auto record = [&order, &counter](std::size_t phase) {
+    return SleepFunc{[&order, &counter, phase] {
+      order[phase] = par::fetch_and_add(counter, 1);
+    }};
+  };
+
+  // Pressure and sound speed both depend on the density, but not on each
+  // other. Acceleration reads the pressure, and the last phase overwrites the
+  // density, so it must wait for all the readers.
+  sph::run_step_phases(std::tuple{
+      sph::StepPhase{TypeSet{v}, TypeSet{rho}, record(0)},
+      sph::StepPhase{TypeSet{rho}, TypeSet{p}, record(1)},
+      sph::StepPhase{TypeSet{rho}, TypeSet{cs}, record(2)},
+      sph::StepPhase{TypeSet{rho, p}, TypeSet{dv_dt}, record(3)},
+      sph::StepPhase{TypeSet{v}, TypeSet{rho}, record(4)},
+  });
+  CHECK(counter == 5);
+  CHECK(order[0] == 0);
+  CHECK(order[1] < order[3]);
+  CHECK(order[4] == 4);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
@@ -5,10 +5,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <optional>
+#include <span>
 #include <utility>
 
+#include "tit/core/arena.hpp"
+#include "tit/core/assert.hpp"
+#include "tit/core/float.hpp"
+#include "tit/core/math.hpp"
 #include "tit/core/profiler.hpp"
 #include "tit/core/type.hpp"
 #include "tit/par/algorithms.hpp"
@@ -25,6 +33,58 @@ namespace tit::sph {
 template<class EE>
 concept explicit_equations = specialization_of<EE, FluidEquations>;
 
+namespace impl {
+
+template<class Equations>
+struct equations_num;
+template<class Num, class... Args>
+struct equations_num<FluidEquations<Num, Args...>> {
+  using type = Num;
+};
+
+} // namespace impl
+
+/// Set of the specified fields if the equations are solved in the reduced
+/// precision, and an empty set otherwise.
+template<explicit_equations Equations, field... Fields>
+inline constexpr auto reduced_precision_fields_v = [] {
+  using Num = impl::equations_num<Equations>::type;
+  if constexpr (sizeof(Num) < sizeof(float64_t)) return TypeSet<Fields...>{};
+  else return TypeSet<>{};
+}();
+
+/// Add the increment to the particle position.
+///
+/// If the position round-off error is stored, the increment is added with
+/// the compensated summation, so that the small increments are not lost in
+/// the reduced precision.
+template<particle_view<r> PV>
+constexpr void add_position(PV a, const particle_vec_t<PV>& delta) {
+  if constexpr (has<PV>(r_err)) {
+    KahanSum position{r[a], r_err[a]};
+    position += delta;
+    r[a] = position.sum();
+    r_err[a] = position.error();
+  } else {
+    r[a] += delta;
+  }
+}
+
+/// Largest displacement of the fluid particles that move with their current
+/// velocities over the time step.
+template<particle_array ParticleArray>
+auto max_displacement(ParticleArray& particles,
+                      particle_num_t<ParticleArray> dt) -> float64_t {
+  using PV = ParticleView<ParticleArray>;
+  using Num = particle_num_t<ParticleArray>;
+  const auto max_v = par::fold(
+      particles.fluid(),
+      Num{0},
+      [](Num v_max, PV a) { return std::max(v_max, norm(v[a])); },
+      [](Num v_max_a, Num v_max_b) { return std::max(v_max_a, v_max_b); });
+  return static_cast<float64_t>(dt * max_v);
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 /// Symplectic Euler time integrator.
@@ -34,11 +94,13 @@ public:
 
   /// Set of particle fields that are required.
   static constexpr auto required_fields =
-      Equations::required_fields | TypeSet{r, dr, v, dv_dt, drho_dt};
+      Equations::required_fields | TypeSet{r, dr, v, dv_dt, drho_dt} |
+      reduced_precision_fields_v<Equations, r_err_t>;
 
   /// Set of particle fields that are modified.
   static constexpr auto modified_fields =
-      Equations::modified_fields | TypeSet{r, v, rho};
+      Equations::modified_fields | TypeSet{r, v, rho} |
+      reduced_precision_fields_v<Equations, r_err_t>;
 
   /// Construct time integrator.
   constexpr explicit SymplecticEulerIntegrator(Equations equations) noexcept
@@ -61,8 +123,9 @@ public:
     equations_.compute_momentum(mesh, particles);
     par::for_each(particles.fluid(), [dt](PV a) {
       v[a] += dt * dv_dt[a];
-      r[a] += dt * v[a];
+      add_position(a, dt * v[a]);
     });
+    particles.touch(max_displacement(particles, dt));
 
     equations_.post_integrate(mesh, particles);
     return dt;
@@ -83,11 +146,13 @@ public:
 
   /// Set of particle fields that are required.
   static constexpr auto required_fields =
-      Equations::required_fields | TypeSet{r, dr, v, dv_dt, drho_dt};
+      Equations::required_fields | TypeSet{r, dr, v, dv_dt, drho_dt} |
+      reduced_precision_fields_v<Equations, r_err_t>;
 
   /// Set of particle fields that are modified.
   static constexpr auto modified_fields =
-      Equations::modified_fields | TypeSet{r, v, rho};
+      Equations::modified_fields | TypeSet{r, v, rho} |
+      reduced_precision_fields_v<Equations, r_err_t>;
 
   /// Construct time integrator.
   constexpr explicit VelocityVerletIntegrator(Equations equations) noexcept
@@ -108,8 +173,9 @@ public:
     equations_.compute_momentum(mesh, particles);
     par::for_each(particles.fluid(), [dt, dt_2](PV a) {
       v[a] += dt_2 * dv_dt[a];
-      r[a] += dt * v[a];
+      add_position(a, dt * v[a]);
     });
+    particles.touch(max_displacement(particles, dt));
 
     equations_.prepare(mesh, particles);
     equations_.compute_continuity(mesh, particles);
@@ -137,17 +203,24 @@ enum class SSPRKOrder : std::uint8_t {
 };
 
 /// Strong-stability-preserving Runge-Kutta time integrator.
+///
+/// State at the beginning of the step is stored in the dedicated particle
+/// fields, so that only the integrated fields are preserved between the
+/// stages, and the stage storage is reused across the steps.
 template<explicit_equations Equations>
 class SSPRKIntegrator final {
 public:
 
   /// Set of particle fields that are required.
   static constexpr auto required_fields =
-      Equations::required_fields | TypeSet{r, dr, v, dv_dt, drho_dt};
+      Equations::required_fields |
+      TypeSet{r, dr, v, dv_dt, drho_dt, r_n, v_n, rho_n} |
+      reduced_precision_fields_v<Equations, r_err_t, r_err_n_t>;
 
   /// Set of particle fields that are modified.
   static constexpr auto modified_fields =
-      Equations::modified_fields | TypeSet{r, v, rho};
+      Equations::modified_fields | TypeSet{r, v, rho, r_n, v_n, rho_n} |
+      reduced_precision_fields_v<Equations, r_err_t, r_err_n_t>;
 
   /// Construct time integrator.
   constexpr explicit SSPRKIntegrator(
@@ -161,20 +234,16 @@ public:
   auto step(ParticleMesh& mesh, ParticleArray& particles) const
       -> particle_num_t<ParticleArray> {
     TIT_PROFILE_SECTION("SSPRKIntegrator::step()");
-    const auto old_particles(particles);
-    const auto dt = substep_(mesh, particles);
-
     using Num = particle_num_t<ParticleArray>;
+
+    const auto dt = substep_(mesh, particles);
     switch (order_) {
       case SSPRKOrder::two:
-        substep_(mesh, particles, dt);
-        lincomb_(old_particles, particles, Num{1.0 / 2.0});
+        substep_(mesh, particles, dt, Num{1.0 / 2.0});
         break;
       case SSPRKOrder::three:
-        substep_(mesh, particles, dt);
-        lincomb_(old_particles, particles, Num{1.0 / 4.0});
-        substep_(mesh, particles, dt);
-        lincomb_(old_particles, particles, Num{2.0 / 3.0});
+        substep_(mesh, particles, dt, Num{1.0 / 4.0});
+        substep_(mesh, particles, dt, Num{2.0 / 3.0});
         break;
       default: std::unreachable();
     }
@@ -185,47 +254,246 @@ public:
 
 private:
 
+  // Make a forward Euler substep, and blend the result with the state at the
+  // beginning of the step with the given weight. If time step is not given,
+  // it is computed, and the current state is stored as the initial one.
   template<particle_mesh ParticleMesh,
            particle_array<required_fields> ParticleArray>
   auto substep_(ParticleMesh& mesh,
                 ParticleArray& particles,
-                std::optional<particle_num_t<ParticleArray>> dt =
-                    std::nullopt) const -> particle_num_t<ParticleArray> {
+                std::optional<particle_num_t<ParticleArray>> dt = std::nullopt,
+                particle_num_t<ParticleArray> weight = 1) const
+      -> particle_num_t<ParticleArray> {
     using PV = ParticleView<ParticleArray>;
+    using Num = particle_num_t<ParticleArray>;
 
     equations_.prepare(mesh, particles);
-    if (!dt.has_value()) dt = equations_.compute_time_step(particles);
+    const auto is_first = !dt.has_value();
+    if (is_first) dt = equations_.compute_time_step(particles);
     const auto dt_ = dt.value();
 
-    equations_.compute_continuity(mesh, particles);
-    equations_.compute_momentum(mesh, particles);
+    equations_.compute_rhs(mesh, particles);
+
+    // Positions are blended with the initial ones, so the displacement is
+    // bounded by the blend of the distance from the initial positions and
+    // of the displacement with the current velocities.
+    auto max_dr = max_displacement(particles, dt_);
+    if (!is_first) {
+      const auto max_dr_n = par::fold(
+          particles.fluid(),
+          Num{0},
+          [](Num dr_max, PV a) {
+            return std::max(dr_max, norm(r[a] - r_n[a]));
+          },
+          [](Num dr_max_a, Num dr_max_b) {
+            return std::max(dr_max_a, dr_max_b);
+          });
+      max_dr = static_cast<float64_t>(1 - weight) *
+                   static_cast<float64_t>(max_dr_n) +
+               static_cast<float64_t>(weight) * max_dr;
+    }
 
-    par::for_each(particles.fluid(), [dt_](PV a) {
-      r[a] += dt_ * v[a];
-      v[a] += dt_ * dv_dt[a];
-      rho[a] += dt_ * drho_dt[a];
+    par::for_each(particles.fluid(), [dt_, weight, is_first](PV a) {
+      if (is_first) {
+        r_n[a] = r[a];
+        v_n[a] = v[a];
+        rho_n[a] = rho[a];
+        if constexpr (has<PV>(r_err_n)) r_err_n[a] = r_err[a];
+        add_position(a, dt_ * v[a]);
+        v[a] += dt_ * dv_dt[a];
+        rho[a] += dt_ * drho_dt[a];
+        return;
+      }
+
+      const auto weight_n = 1 - weight;
+      if constexpr (has<PV>(r_err, r_err_n)) {
+        // Blend the displacements from the initial positions rather than
+        // the positions themselves, and add them with the compensation.
+        const auto dr_a = (r[a] - r_n[a]) - (r_err[a] - r_err_n[a]);
+        r[a] = r_n[a];
+        r_err[a] = r_err_n[a];
+        add_position(a, weight * (dr_a + dt_ * v[a]));
+      } else {
+        r[a] = weight_n * r_n[a] + weight * (r[a] + dt_ * v[a]);
+      }
+      v[a] = weight_n * v_n[a] + weight * (v[a] + dt_ * dv_dt[a]);
+      rho[a] = weight_n * rho_n[a] + weight * (rho[a] + dt_ * drho_dt[a]);
     });
+    particles.touch(max_dr);
 
     return dt_;
   }
 
-  template<particle_array<required_fields> ParticleArray>
-  static void lincomb_(const ParticleArray& particles,
-                       ParticleArray& out_particles,
-                       particle_num_t<ParticleArray> weight) {
+  [[no_unique_address]] Equations equations_;
+  SSPRKOrder order_{SSPRKOrder::three};
+
+}; // class SSPRKIntegrator
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/// Assign the fluid particles to the power-of-two time step bins.
+///
+/// Particle is first assigned to the largest bin `k <= max_bin`, such that
+/// `2^k * dt_min` does not exceed its local time step. Then the bins are
+/// limited, so that the neighboring fluid particles differ by at most one
+/// bin, and the fast particles are not missed by their slow neighbors. The
+/// limiter is iterated to the fixed point, since a single pass propagates the
+/// limit only to the immediate neighbors.
+///
+/// @param bins Output bins of the particles, indexed by the particle index.
+///             Bins of the non-fluid particles are set to zero.
+///
+/// @returns Largest bin in use.
+template<class Mesh, particle_array ParticleArray, class LocalTimeStepFunc>
+auto assign_time_step_bins(const Mesh& mesh,
+                           ParticleArray& particles,
+                           particle_num_t<ParticleArray> dt_min,
+                           const LocalTimeStepFunc& local_time_step_func,
+                           std::size_t max_bin,
+                           std::span<std::size_t> bins) -> std::size_t {
+  using PV = ParticleView<ParticleArray>;
+  using Num = particle_num_t<ParticleArray>;
+  TIT_ASSERT(bins.size() == particles.size(), "Bins size mismatch!");
+
+  // Assign the bins from the local time steps.
+  std::ranges::fill(bins, 0);
+  par::for_each(particles.fluid(),
+                [dt_min, max_bin, &local_time_step_func, bins](PV a) {
+                  auto& bin = bins[a.index()];
+                  const auto dt_a = local_time_step_func(a);
+                  while (bin < max_bin &&
+                         dt_min * static_cast<Num>(std::size_t{1} << (bin + 1))
+                             <= dt_a) {
+                    bin += 1;
+                  }
+                });
+
+  // Limit the bins. Each pass reads the bins of the previous one, and the
+  // limit travels one neighbor further per pass. Since the bins are bounded
+  // by `max_bin`, the fixed point is reached in at most `max_bin` passes.
+  ArenaVector<std::size_t> prev_bins(bins.size());
+  for (std::size_t pass = 0; pass < max_bin; ++pass) {
+    std::ranges::copy(bins, prev_bins.begin());
+    const auto changed = par::fold(
+        particles.fluid(),
+        false,
+        [&mesh, &prev_bins, bins](bool changed_a, PV a) {
+          auto bin = prev_bins[a.index()];
+          for (const PV b : mesh[a]) {
+            if (b.is_fluid()) bin = std::min(bin, prev_bins[b.index()] + 1);
+          }
+          bins[a.index()] = bin;
+          return changed_a || bin != prev_bins[a.index()];
+        },
+        std::logical_or{});
+    if (!changed) break;
+  }
+
+  return par::fold(
+      particles.fluid(),
+      std::size_t{0},
+      [bins](std::size_t bin, PV a) {
+        return std::max(bin, bins[a.index()]);
+      },
+      [](std::size_t bin_a, std::size_t bin_b) {
+        return std::max(bin_a, bin_b);
+      });
+}
+
+/// Multirate time integrator.
+///
+/// Fluid particles are sorted into the power-of-two time step bins: particle
+/// in bin `k` is advanced with the time step `2^k * dt_min`, where `dt_min` is
+/// the global minimal time step. Each step consists of `2^K` substeps of size
+/// `dt_min`, where `K` is the largest bin in use. On each substep, right-hand
+/// sides are computed and integrated only for the particles whose time step
+/// begins at this substep, and all the particles are advected. Active
+/// particles are integrated as in the symplectic Euler scheme, so that the
+/// integrator reduces to `SymplecticEulerIntegrator` if all the particles are
+/// in the bin zero.
+template<explicit_equations Equations>
+class MultirateIntegrator final {
+public:
+
+  /// Set of particle fields that are required.
+  static constexpr auto required_fields =
+      Equations::required_fields | TypeSet{r, dr, v, dv_dt, drho_dt} |
+      reduced_precision_fields_v<Equations, r_err_t>;
+
+  /// Set of particle fields that are modified.
+  static constexpr auto modified_fields =
+      Equations::modified_fields | TypeSet{r, v, rho} |
+      reduced_precision_fields_v<Equations, r_err_t>;
+
+  /// Construct time integrator.
+  ///
+  /// @param max_bin Largest time step bin, so that the local time steps are
+  ///                at most `2^max_bin` times larger than the global one.
+  constexpr explicit MultirateIntegrator(Equations equations,
+                                         std::size_t max_bin = 3) noexcept
+      : equations_{std::move(equations)}, max_bin_{max_bin} {
+    TIT_ASSERT(max_bin_ < 16, "Largest time step bin is too large!");
+  }
+
+  /// Make a step in time.
+  template<particle_mesh ParticleMesh,
+           particle_array<required_fields> ParticleArray>
+  auto step(ParticleMesh& mesh, ParticleArray& particles) const
+      -> particle_num_t<ParticleArray> {
+    TIT_PROFILE_SECTION("MultirateIntegrator::step()");
     using PV = ParticleView<ParticleArray>;
-    par::for_each(out_particles.fluid(), [weight, &particles](PV out_a) {
-      const auto a = particles[out_a.index()];
-      r[out_a] = (1 - weight) * r[a] + weight * r[out_a];
-      v[out_a] = (1 - weight) * v[a] + weight * v[out_a];
-      rho[out_a] = (1 - weight) * rho[a] + weight * rho[out_a];
-    });
+    using Num = particle_num_t<ParticleArray>;
+
+    equations_.prepare(mesh, particles);
+    const auto dt_min = equations_.compute_time_step(particles);
+
+    // Assign the fluid particles to the time step bins.
+    ArenaVector<std::size_t> bins(particles.size());
+    const auto top_bin = assign_time_step_bins(
+        mesh,
+        particles,
+        dt_min,
+        [this](PV a) { return equations_.compute_local_time_step(a); },
+        max_bin_,
+        bins);
+
+    // Advance the particles through the substeps.
+    const auto num_substeps = std::size_t{1} << top_bin;
+    for (std::size_t substep = 0; substep < num_substeps; ++substep) {
+      // Fixed particles are not integrated, thus they are never active.
+      const auto is_active = [substep, &bins](PV a) {
+        if (!a.is_fluid()) return false;
+        return substep % (std::size_t{1} << bins[a.index()]) == 0;
+      };
+      const auto dt_of = [dt_min, &bins](PV a) {
+        return dt_min * static_cast<Num>(std::size_t{1} << bins[a.index()]);
+      };
+
+      if (substep != 0) equations_.prepare(mesh, particles);
+
+      equations_.compute_continuity(mesh, particles, is_active);
+      par::for_each(particles.fluid(), [&is_active, &dt_of](PV a) {
+        if (is_active(a)) rho[a] += dt_of(a) * drho_dt[a];
+      });
+
+      equations_.compute_momentum(mesh, particles, is_active);
+      par::for_each(particles.fluid(), [dt_min, &is_active, &dt_of](PV a) {
+        if (is_active(a)) v[a] += dt_of(a) * dv_dt[a];
+        add_position(a, dt_min * v[a]);
+      });
+      particles.touch(max_displacement(particles, dt_min));
+    }
+
+    equations_.post_integrate(mesh, particles);
+    return dt_min * static_cast<Num>(num_substeps);
   }
 
+private:
+
   [[no_unique_address]] Equations equations_;
-  SSPRKOrder order_{SSPRKOrder::three};
+  std::size_t max_bin_ = 3;
 
-}; // class SSPRKIntegrator
+}; // class MultirateIntegrator
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -0,0 +1,209 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cstddef>
+#include <vector>
+
+#include "tit/core/type.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/geom/face_search.hpp"
+#include "tit/geom/partition.hpp"
+#include "tit/geom/search.hpp"
+#include "tit/geom/surface.hpp"
+#include "tit/geom/tessellation.hpp"
+#include "tit/geom/winding/fast_winding.hpp"
+#include "tit/par/control.hpp"
+#include "tit/sph/equation_of_state.hpp"
+#include "tit/sph/field.hpp"
+#include "tit/sph/fluid_equations.hpp"
+#include "tit/sph/kernel.hpp"
+#include "tit/sph/particle_array.hpp"
+#include "tit/sph/particle_generator.hpp"
+#include "tit/sph/particle_mesh.hpp"
+#include "tit/sph/time_integrator.hpp"
+#include "tit/testing/test.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Equations stub that defines the particle fields.
+struct Equations final {
+  static constexpr TypeSet required_fields{sph::r};
+  static constexpr TypeSet modified_fields{sph::r};
+};
+
+using ParticleArray = decltype(sph::ParticleArray{sph::Space<double, 2>{},
+                                                  Equations{}});
+using PV = sph::ParticleView<ParticleArray>;
+
+// Mesh stub that connects the particles into a chain.
+struct ChainMesh final {
+  auto operator[](PV a) const -> std::vector<PV> {
+    auto& particles = a.array();
+    std::vector<PV> result;
+    if (a.index() > 0) result.push_back(particles[a.index() - 1]);
+    if (a.index() + 1 < particles.size()) {
+      result.push_back(particles[a.index() + 1]);
+    }
+    return result;
+  }
+};
+
+TEST_CASE("sph::assign_time_step_bins") {
+  par::set_num_threads(4);
+  ParticleArray particles{sph::Space<double, 2>{}, Equations{}};
+  particles.append_n(sph::ParticleType::fluid, 8);
+  particles.append_n(sph::ParticleType::fixed, 1);
+  std::vector<std::size_t> bins(particles.size(), 123);
+
+  // Only the first particle requires the minimal time step.
+  const auto local_time_step = [](PV a) {
+    return a.index() == 0 ? 1.0 : 100.0;
+  };
+  SUBCASE("limited") {
+    // Limit must travel along the whole chain, fixed particle shall not
+    // limit its fluid neighbor.
+    const auto top_bin = sph::assign_time_step_bins(ChainMesh{},
+                                                    particles,
+                                                    1.0,
+                                                    local_time_step,
+                                                    3,
+                                                    bins);
+    CHECK(top_bin == 3);
+    CHECK_RANGE_EQ(bins, {0, 1, 2, 3, 3, 3, 3, 3, 0});
+  }
+  SUBCASE("single bin") {
+    const auto top_bin = sph::assign_time_step_bins(ChainMesh{},
+                                                    particles,
+                                                    1.0,
+                                                    local_time_step,
+                                                    0,
+                                                    bins);
+    CHECK(top_bin == 0);
+    CHECK_RANGE_EQ(bins, {0, 0, 0, 0, 0, 0, 0, 0, 0});
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TEST_CASE("sph::MultirateIntegrator") {
+  par::set_num_threads(4);
+
+  // Small water column in a pool.
+  constexpr double dr = 0.01;
+  constexpr double g = 9.81;
+  constexpr double rho_0 = 1000.0;
+  constexpr double cs_0 = 20.0;
+  constexpr double h_0 = 2.0 * dr;
+  constexpr double m_0 = rho_0 * dr * dr;
+  constexpr double mu = 0.001;
+  geom::Surface<Vec<double, 2>> domain;
+  domain.append_vert({0.0, 0.2});
+  domain.append_vert({0.2, 0.2});
+  domain.append_vert({0.2, 0.0});
+  domain.append_vert({0.0, 0.0});
+  domain.append_face({0, 1});
+  domain.append_face({1, 2});
+  domain.append_face({2, 3});
+  domain.append_face({3, 0});
+  domain = geom::tessellate(domain, dr);
+  geom::Surface<Vec<double, 2>> domain2;
+  domain2.append_vert({0.0, 0.0});
+  domain2.append_vert({0.2, 0.0});
+  domain2.append_vert({0.2, 0.2});
+  domain2.append_vert({0.0, 0.2});
+  domain2.append_face({0, 1});
+  domain2.append_face({1, 2});
+  domain2.append_face({2, 3});
+  domain2.append_face({3, 0});
+  const geom::MakeFastWinding<double> make_winding;
+  const auto containment = make_winding(domain2);
+  const sph::FluidEquations equations{
+      g,
+      mu,
+      domain,
+      containment,
+      sph::TaitEquationOfState{cs_0, rho_0},
+      sph::SixthOrderWendlandKernel{},
+  };
+
+  // Setup the particles and the mesh for the integrator.
+  const auto make_particles = [&](const auto& time_integrator) {
+    sph::ParticleArray particles{sph::Space<double, 2>{}, time_integrator};
+    sph::append_lattice(particles,
+                        sph::ParticleType::fluid,
+                        Vec<double, 2>(dr),
+                        dr,
+                        {std::size_t{8}, std::size_t{8}});
+    sph::append_surface(particles, sph::ParticleType::fixed, domain);
+    h[particles] = h_0;
+    for (const auto a : particles.all()) {
+      m[a] = m_0;
+      rho[a] = rho_0;
+    }
+    return particles;
+  };
+  const auto make_mesh = [] {
+    return sph::ParticleMesh{
+        geom::GridSearch{h_0},
+        geom::GridFaceSearch{h_0},
+        geom::RecursiveInertialBisection{},
+        geom::SparsePixelatedPartition{2 * h_0, geom::KMeansClustering{}},
+    };
+  };
+
+  SUBCASE("single-rate") {
+    // With a single bin, the integrator must reduce to the symplectic Euler.
+    const sph::SymplecticEulerIntegrator single_rate{equations};
+    const sph::MultirateIntegrator multirate{equations, 0};
+    auto single_rate_particles = make_particles(single_rate);
+    auto multirate_particles = make_particles(multirate);
+    auto single_rate_mesh = make_mesh();
+    auto multirate_mesh = make_mesh();
+    equations.initialize(single_rate_mesh, single_rate_particles);
+    equations.initialize(multirate_mesh, multirate_particles);
+    for (std::size_t step = 0; step < 5; ++step) {
+      const auto single_rate_dt =
+          single_rate.step(single_rate_mesh, single_rate_particles);
+      const auto multirate_dt =
+          multirate.step(multirate_mesh, multirate_particles);
+      REQUIRE_APPROX_EQ(single_rate_dt, multirate_dt);
+    }
+    for (std::size_t i = 0; i < single_rate_particles.size(); ++i) {
+      const auto a = single_rate_particles[i];
+      const auto b = multirate_particles[i];
+      CHECK_APPROX_EQ(sph::r[a], sph::r[b]);
+      CHECK_APPROX_EQ(v[a], v[b]);
+      CHECK_APPROX_EQ(rho[a], rho[b]);
+    }
+  }
+  SUBCASE("multirate") {
+    // Larger steps must be composed of the power-of-two global ones, and
+    // the particles must remain inside the pool.
+    const sph::MultirateIntegrator multirate{equations, 2};
+    auto particles = make_particles(multirate);
+    auto mesh = make_mesh();
+    equations.initialize(mesh, particles);
+    for (std::size_t step = 0; step < 5; ++step) {
+      equations.prepare(mesh, particles);
+      const auto dt_min = equations.compute_time_step(particles);
+      const auto dt = multirate.step(mesh, particles);
+      const auto ratio = dt / dt_min;
+      CHECK((ratio == 1.0 || ratio == 2.0 || ratio == 4.0));
+    }
+    for (const auto a : particles.fluid()) {
+      CHECK(sph::r[a][0] > 0.0);
+      CHECK(sph::r[a][0] < 0.2);
+      CHECK(sph::r[a][1] > 0.0);
+    }
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
@@ -5,6 +5,8 @@
 
 #include <cstddef>
 
+#include "tit/core/arena.hpp"
+#include "tit/core/env.hpp"
 #include "tit/core/float.hpp"
 #include "tit/core/logging.hpp"
 #include "tit/core/main.hpp"
@@ -18,12 +20,15 @@
 #include "tit/geom/tessellation.hpp"
 #include "tit/geom/winding.hpp"
 #include "tit/geom/winding/fast_winding.hpp"
+#include "tit/par/algorithms.hpp"
 #include "tit/par/control.hpp"
 #include "tit/sph/equation_of_state.hpp"
 #include "tit/sph/field.hpp"
 #include "tit/sph/fluid_equations.hpp"
 #include "tit/sph/kernel.hpp"
+#include "tit/sph/open_boundary.hpp"
 #include "tit/sph/particle_array.hpp"
+#include "tit/sph/particle_generator.hpp"
 #include "tit/sph/particle_mesh.hpp"
 #include "tit/sph/time_integrator.hpp"
 
@@ -100,32 +105,23 @@ auto sph_main(int /*argc*/, char** /*argv*/) -> int {
       time_integrator,
   };
 
-  // Generate individual particles.
-  for (auto i = 0; i < WATER_M; ++i) {
-    for (auto j = 0; j < WATER_N; ++j) {
-      auto a = particles.append(ParticleType::fluid);
-      r[a] = dr * Vec{i + Real{1.0}, j + Real{1.0}};
-    }
-  }
-  for (std::size_t i = 0; i < domain.num_verts(); ++i) {
-    auto a = particles.append(ParticleType::fixed);
-    r[a] = domain.vert(i);
-  }
+  // Generate the particles.
+  append_lattice(particles,
+                 ParticleType::fluid,
+                 Vec<Real, 2>(dr),
+                 dr,
+                 {std::size_t{WATER_M}, std::size_t{WATER_N}});
+  append_surface(particles, ParticleType::fixed, domain);
 
   // Set global particle constants.
   h[particles] = h_0;
-  for (const auto a : particles.all()) {
+  par::for_each(particles.all(), [](auto a) {
     m[a] = m_0;
     rho[a] = rho_0;
-  }
+  });
 
   // Density hydrostatic initialization.
-  for (const auto a : particles.all()) {
-    if (a.has_type(ParticleType::fixed)) {
-      rho[a] = rho_0;
-      continue;
-    }
-
+  par::for_each(particles.fluid(), [](auto a) {
     // Compute pressure from Poisson problem.
     const auto x = r[a][0];
     const auto y = r[a][1];
@@ -139,7 +135,10 @@ auto sph_main(int /*argc*/, char** /*argv*/) -> int {
 
     // Recalculate density.
     rho[a] = rho_0 + p_a / pow2(cs_0);
-  }
+  });
+
+  // Distribute the particle data across the NUMA nodes.
+  particles.first_touch();
 
   // Setup the particle mesh structure.
   ParticleMesh mesh{
@@ -149,8 +148,12 @@ auto sph_main(int /*argc*/, char** /*argv*/) -> int {
       geom::GridFaceSearch{h_0},
       // Use RIB as the primary partitioning method.
       geom::RecursiveInertialBisection{},
-      // Use pixelated K-means as the interface partitioning method.
-      geom::PixelatedPartition{2 * h_0, geom::KMeansClustering{}},
+      // Use sparse pixelated K-means as the interface partitioning method.
+      geom::SparsePixelatedPartition{2 * h_0, geom::KMeansClustering{}},
+      // Repartition from scratch every 10 updates, incrementally in between.
+      10,
+      // Pad the search radii by 5%, so that the mesh survives the shifts.
+      0.05,
   };
 
   // Initialize the particles.
@@ -163,8 +166,11 @@ auto sph_main(int /*argc*/, char** /*argv*/) -> int {
   const auto series = storage.create_series();
   particles.write(0.0, series);
 
-  // Run the simulation.
-  Real time{};
+  // Run the simulation. Time is accumulated in double precision regardless
+  // of the particle data precision.
+  float64_t time{};
+  const auto end_time = get_env("TIT_WCSPH_END_TIME", 10.0);
+  Arena step_arena{};
   Stopwatch exec_time{};
   Stopwatch print_time{};
   for (std::size_t step = 1;; ++step) {
@@ -178,10 +184,11 @@ auto sph_main(int /*argc*/, char** /*argv*/) -> int {
     Real dt{};
     {
       const StopwatchCycle cycle{exec_time};
+      // Step temporaries are allocated from the arena, and released at once.
+      const ArenaScope arena_scope{step_arena};
       dt = time_integrator.step(mesh, particles);
     }
 
-    const auto end_time = 10.0;
     const auto end = scaled_time >= end_time;
     if ((step % 100 == 0) || end) {
       const StopwatchCycle cycle{print_time};
@@ -197,10 +204,165 @@ auto sph_main(int /*argc*/, char** /*argv*/) -> int {
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+template<class Real>
+auto channel_main(int /*argc*/, char** /*argv*/) -> int {
+  constexpr Real H = 0.2;     // Channel height.
+  constexpr Real L = 5.0 * H; // Channel length.
+
+  constexpr Real dr = H / 20.0; // Initial particle spacing.
+  constexpr Real v_in = 1.0;    // Inflow velocity.
+
+  constexpr Real g = 9.81;
+  constexpr Real rho_0 = 1000.0;
+  constexpr Real cs_0 = 20 * v_in;
+  constexpr Real h_0 = 2.0 * dr;
+  constexpr Real m_0 = rho_0 * pow(dr, 2);
+  constexpr Real mu = 0.001;
+
+  // Buffer zones must be at least as deep as the kernel support.
+  const SixthOrderWendlandKernel kernel{};
+  const auto depth = kernel.radius(h_0);
+  const auto M = static_cast<std::size_t>(round((L + 2 * depth) / dr));
+  const auto N = static_cast<std::size_t>(round(H / dr));
+
+  // Setup the channel walls. Channel is open at both ends, where the buffer
+  // zones are located.
+  geom::Surface<Vec<Real, 2>> domain;
+  domain.append_vert({-depth, H});
+  domain.append_vert({L + depth, H});
+  domain.append_vert({L + depth, 0.0});
+  domain.append_vert({-depth, 0.0});
+  domain.append_face({0, 1});
+  domain.append_face({2, 3});
+  domain = geom::tessellate(domain, dr);
+
+  // Closed channel for containment tests.
+  geom::Surface<Vec<Real, 2>> domain2;
+  domain2.append_vert({-depth, 0.0});
+  domain2.append_vert({L + depth, 0.0});
+  domain2.append_vert({L + depth, H});
+  domain2.append_vert({-depth, H});
+  domain2.append_face({0, 1});
+  domain2.append_face({1, 2});
+  domain2.append_face({2, 3});
+  domain2.append_face({3, 0});
+  const geom::MakeFastWinding<Real> make_winding;
+  const auto containment = make_winding(domain2);
+
+  const FluidEquations equations{
+      // Constants.
+      g,
+      mu,
+      // Wall boundary.
+      domain,
+      containment,
+      // Weakly compressible equation of state.
+      TaitEquationOfState{cs_0, rho_0},
+      // C4 Wendland's spline kernel.
+      kernel,
+  };
+
+  // Setup the time integrator.
+  const SSPRKIntegrator time_integrator{equations, SSPRKOrder::three};
+
+  // Setup the particles array.
+  ParticleArray particles{Space<Real, 2>{}, time_integrator};
+
+  // Fill the channel and the buffer zones with the moving fluid.
+  append_lattice(particles,
+                 ParticleType::fluid,
+                 Vec<Real, 2>{-depth + dr / 2, dr / 2},
+                 dr,
+                 {M, N});
+  append_surface(particles, ParticleType::fixed, domain);
+  h[particles] = h_0;
+  par::for_each(particles.all(), [](auto a) {
+    m[a] = m_0;
+    rho[a] = rho_0;
+    if (a.is_fluid()) v[a] = {v_in, 0.0};
+  });
+  particles.first_touch();
+
+  // Setup the open boundary.
+  OpenBoundary boundary{Vec<Real, 2>{0.0, 0.0},
+                        Vec<Real, 2>{1.0, 0.0},
+                        Vec<Real, 2>{L, 0.0},
+                        Vec<Real, 2>{-1.0, 0.0},
+                        depth,
+                        v_in,
+                        rho_0};
+
+  // Setup the particle mesh structure.
+  ParticleMesh mesh{
+      geom::GridSearch{h_0},
+      geom::GridFaceSearch{h_0},
+      geom::RecursiveInertialBisection{},
+      geom::SparsePixelatedPartition{2 * h_0, geom::KMeansClustering{}},
+      10,
+      0.05,
+  };
+
+  // Initialize the particles.
+  boundary.update(particles);
+  equations.initialize(mesh, particles);
+
+  data::Storage storage{"./particles.ttdb"};
+  storage.set_max_series(1);
+  const auto series = storage.create_series();
+  particles.write(0.0, series);
+
+  // Run the simulation. Particles are spawned, recycled and parked after
+  // each step.
+  float64_t time{};
+  const auto end_time = get_env("TIT_WCSPH_END_TIME", 2.0);
+  Arena step_arena{};
+  Stopwatch exec_time{};
+  Stopwatch print_time{};
+  for (std::size_t step = 1;; ++step) {
+    log("{:>15}\t\t{:>10.5f}\t\t{:>10.5f}\t\t{:>10.5f}\t\t{:>10}",
+        step,
+        time,
+        exec_time.cycle(),
+        print_time.cycle(),
+        particles.num_parked());
+
+    Real dt{};
+    {
+      const StopwatchCycle cycle{exec_time};
+      const ArenaScope arena_scope{step_arena};
+      dt = time_integrator.step(mesh, particles);
+      boundary.update(particles);
+    }
+
+    const auto end = time >= end_time;
+    if ((step % 100 == 0) || end) {
+      const StopwatchCycle cycle{print_time};
+      particles.write(time, series);
+    }
+
+    if (end) break;
+    time += dt;
+  }
+
+  return 0;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 } // namespace
 } // namespace tit::sph::wcsph
 
 TIT_IMPLEMENT_MAIN([](int argc, char** argv) {
   par::init();
-  sph::wcsph::sph_main<tit::float64_t>(argc, argv);
+  if (get_env("TIT_WCSPH_CHANNEL", false)) {
+    // Channel flow case exercises the open boundaries.
+    sph::wcsph::channel_main<tit::float64_t>(argc, argv);
+  } else if (get_env("TIT_WCSPH_FLOAT32", false)) {
+    // Reduced precision mode halves the particle data size. Positions are
+    // stored with their round-off errors, so that the small displacements
+    // are not lost.
+    sph::wcsph::sph_main<tit::float32_t>(argc, argv);
+  } else {
+    sph::wcsph::sph_main<tit::float64_t>(argc, argv);
+  }
 });
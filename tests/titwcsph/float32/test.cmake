@@ -0,0 +1,15 @@
+# ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+# Part of BlueTit Solver, under the MIT License.
+# See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+# ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+# Single precision dam breaking must follow the double precision one until the
+# wave hits the opposite wall. Test runs `titwcsph` twice and compares the
+# particle positions frame by frame.
+add_tit_test(
+  NAME "dam_breaking[float32][long]"
+  EXE SOURCES "test.cpp" DEPENDS tit::core tit::data
+  FLAGS RUN_SERIAL
+)
+
+# ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -0,0 +1,145 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ *\
+ * Part of BlueTit Solver, under the MIT License.
+ * See /LICENSE.md for license information. SPDX-License-Identifier: MIT
+\* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <print>
+#include <vector>
+
+#include "tit/core/exception.hpp"
+#include "tit/core/float.hpp"
+#include "tit/core/main.hpp"
+#include "tit/core/math.hpp"
+#include "tit/core/vec.hpp"
+#include "tit/data/storage.hpp"
+#include "tit/data/type.hpp"
+
+namespace tit {
+namespace {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Scaled time until which the runs are compared. The wave reaches the opposite
+// wall at the scaled time of about 2.5, after which the flow is chaotic and
+// the runs are expected to diverge.
+constexpr auto end_time = "2.0";
+
+// Initial particle spacing of the dam breaking case.
+constexpr float64_t dr = 0.6 / 80.0;
+
+// Tolerances for the position error, relative to the particle spacing.
+constexpr float64_t max_rms_error = 0.25;
+constexpr float64_t max_error = 2.0;
+
+// Tolerance for the frame time mismatch. Frames are written every 100 steps,
+// and the time steps of the runs differ slightly.
+constexpr float64_t max_time_error = 1.0e-3;
+
+// Run the solver and return the path to the output.
+auto run_titwcsph(const char* env, const std::filesystem::path& path)
+    -> std::filesystem::path {
+  const auto command = std::format("{} TIT_WCSPH_END_TIME={} titwcsph > {}.log",
+                                   env,
+                                   end_time,
+                                   path.string());
+  TIT_ENSURE(std::system(command.c_str()) == 0,
+             "'{}' failed, see '{}.log'.",
+             command,
+             path.string());
+  std::filesystem::rename("particles.ttdb", path);
+  return path;
+}
+
+// Read the particle positions from the frame in double precision.
+auto read_positions(const data::FrameView<const data::Storage>& frame)
+    -> std::vector<Vec<float64_t, 2>> {
+  const auto array = frame.find_array("r");
+  TIT_ENSURE(array.has_value(), "Positions are missing in the frame.");
+  if (array->type() == data::type_of<Vec<float64_t, 2>>) {
+    return array->read<Vec<float64_t, 2>>();
+  }
+  TIT_ENSURE(array->type() == data::type_of<Vec<float32_t, 2>>,
+             "Unexpected position type '{}'.",
+             array->type().name());
+  const auto positions = array->read<Vec<float32_t, 2>>();
+  std::vector<Vec<float64_t, 2>> result(positions.size());
+  std::ranges::transform(positions,
+                         result.begin(),
+                         [](const auto& r) { return vec_cast<float64_t>(r); });
+  return result;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace
+} // namespace tit
+
+TIT_IMPLEMENT_MAIN([] {
+  using namespace tit;
+
+  // Run the solver in both precisions.
+  const data::Storage storage_64{run_titwcsph("", "float64.ttdb"),
+                                 /*read_only=*/true};
+  const data::Storage storage_32{
+      run_titwcsph("TIT_WCSPH_FLOAT32=1", "float32.ttdb"),
+      /*read_only=*/true};
+  const auto series_64 = storage_64.last_series();
+  const auto series_32 = storage_32.last_series();
+
+  // Compare the positions frame by frame. Output frames are matched by their
+  // index, the frame times must agree.
+  const auto num_frames = std::min(series_64.num_frames(),
+                                   series_32.num_frames());
+  TIT_ENSURE(num_frames > 1, "Not enough frames to compare.");
+  for (std::size_t i = 0; i < num_frames; ++i) {
+    const auto frame_64 = series_64.frame(i);
+    const auto frame_32 = series_32.frame(i);
+    const auto time = frame_64.time();
+    const auto time_error = abs(time - frame_32.time());
+    TIT_ENSURE(time_error <= max_time_error * std::max(time, 1.0),
+               "Frame {} times mismatch: {} vs {}.",
+               i,
+               time,
+               frame_32.time());
+
+    const auto r_64 = read_positions(frame_64);
+    const auto r_32 = read_positions(frame_32);
+    TIT_ENSURE(r_64.size() == r_32.size(),
+               "Frame {} particle counts mismatch: {} vs {}.",
+               i,
+               r_64.size(),
+               r_32.size());
+
+    float64_t sum_sq_error = 0.0;
+    float64_t frame_max_error = 0.0;
+    for (std::size_t a = 0; a < r_64.size(); ++a) {
+      const auto error = norm(r_64[a] - r_32[a]);
+      sum_sq_error += pow2(error);
+      frame_max_error = std::max(frame_max_error, error);
+    }
+    const auto rms_error =
+        sqrt(sum_sq_error / static_cast<float64_t>(r_64.size()));
+    std::println("{:>5} {:>10.5f} {:>12.5e} {:>12.5e}",
+                 i,
+                 time,
+                 rms_error / dr,
+                 frame_max_error / dr);
+    TIT_ENSURE(rms_error <= max_rms_error * dr,
+               "Frame {} (t = {}): RMS position error {} exceeds {}.",
+               i,
+               time,
+               rms_error,
+               max_rms_error * dr);
+    TIT_ENSURE(frame_max_error <= max_error * dr,
+               "Frame {} (t = {}): max position error {} exceeds {}.",
+               i,
+               time,
+               frame_max_error,
+               max_error * dr);
+  }
+});
@@ -15,4 +15,13 @@ add_tit_test(
   ENVIRONMENT TIT_ENABLE_PROFILER=1
 )
 
+# Channel flow through the open boundaries. Particle counts depend on the
+# timing of the spawns, so only a successful run is checked.
+add_tit_test(
+  NAME "channel[long]"
+  COMMAND "titwcsph"
+  FLAGS RUN_SERIAL
+  ENVIRONMENT TIT_WCSPH_CHANNEL=1
+)
+
 # ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~